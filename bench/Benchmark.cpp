@@ -0,0 +1,193 @@
+#include "Benchmark.hpp"
+#include "LException.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// counted by the replaced global `operator new` below
+static std::atomic<size_t> allocation_count{0};
+
+void * operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void * memory = std::malloc(size > 0? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    return memory;
+}
+
+void operator delete(void * memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace LCode
+{
+
+size_t get_allocation_count()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+double BenchResult::get_ns_per_item() const
+{
+    return items > 0? median_ns / static_cast<double>(items) : median_ns;
+}
+
+double BenchResult::get_allocs_per_item() const
+{
+    return items > 0? allocs_per_run / static_cast<double>(items) : allocs_per_run;
+}
+
+std::ostream & operator << (std::ostream & os, const BenchResult & result)
+{
+    std::ios::fmtflags flags = os.flags();
+    os << std::left << std::setw(40) << result.name << std::right << std::fixed
+       << std::setprecision(1)
+       << std::setw(14) << result.median_ns / 1000.0 << " us"
+       << std::setw(12) << result.get_ns_per_item() << " ns/item"
+       << std::setprecision(2)
+       << std::setw(10) << result.get_allocs_per_item() << " allocs/item"
+       << std::setw(9) << result.runs << " runs\n";
+    os.flags(flags);
+    return os;
+}
+
+
+BenchmarkSuite::BenchmarkSuite(const std::string & name_filter, double seconds_per_bench,
+                               size_t max_runs)
+: results{}, filter{name_filter}, min_seconds{seconds_per_bench},
+  default_max_runs{std::max(max_runs, MIN_RUNS)}
+{ }
+
+bool BenchmarkSuite::is_selected(const std::string & name) const
+{
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchmarkSuite::record(const std::string & name, size_t items, std::vector<double> & times,
+                            size_t allocs)
+{
+    std::sort(times.begin(), times.end());
+    BenchResult result;
+    result.name = name;
+    result.items = items;
+    result.runs = times.size();
+    result.median_ns = times[times.size() / 2];
+    result.min_ns = times.front();
+    result.allocs_per_run = static_cast<double>(allocs) / static_cast<double>(times.size());
+    results.push_back(result);
+    std::cout << result << std::flush;
+}
+
+const std::vector<BenchResult> & BenchmarkSuite::get_results() const
+{
+    return results;
+}
+
+void BenchmarkSuite::write_json(std::ostream & os) const
+{
+    os << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult & result = results[i];
+        os << "    {\"name\": \"" << result.name << "\""
+           << ", \"items\": " << result.items
+           << ", \"runs\": " << result.runs
+           << ", \"median_ns\": " << std::setprecision(12) << result.median_ns
+           << ", \"min_ns\": " << result.min_ns
+           << ", \"ns_per_item\": " << result.get_ns_per_item()
+           << ", \"allocs_per_run\": " << result.allocs_per_run
+           << "}" << (i + 1 < results.size()? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// Reads the number after `"key": ` inside `object`, 0 if it is missing.
+static double read_number(const std::string & object, const std::string & key)
+{
+    size_t pos = object.find("\"" + key + "\":");
+    if (pos == std::string::npos)
+    {
+        return 0.0;
+    }
+    return std::strtod(object.c_str() + pos + key.size() + 3, nullptr);
+}
+
+std::vector<BenchResult> BenchmarkSuite::read_json(const std::string & path)
+{
+    std::ifstream file{path};
+    if (!file)
+    {
+        throw LException{"Unable to open benchmark baseline \"" + path + "\"!"};
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+
+    // only the flat objects `write_json()` produces need to be understood
+    std::vector<BenchResult> baseline;
+    size_t begin = json.find("{\"name\": \"");
+    while (begin != std::string::npos)
+    {
+        size_t end = json.find('}', begin);
+        std::string object = json.substr(begin, end - begin);
+        size_t name_begin = object.find(": \"") + 3;
+        BenchResult result;
+        result.name = object.substr(name_begin, object.find('"', name_begin) - name_begin);
+        result.items = static_cast<size_t>(read_number(object, "items"));
+        result.runs = static_cast<size_t>(read_number(object, "runs"));
+        result.median_ns = read_number(object, "median_ns");
+        result.min_ns = read_number(object, "min_ns");
+        result.allocs_per_run = read_number(object, "allocs_per_run");
+        baseline.push_back(result);
+        begin = json.find("{\"name\": \"", end);
+    }
+    return baseline;
+}
+
+size_t BenchmarkSuite::compare(const std::vector<BenchResult> & baseline, double threshold,
+                               std::ostream & os) const
+{
+    size_t regressions = 0;
+    std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(1);
+    for (const BenchResult & result : results)
+    {
+        auto base = std::find_if(baseline.begin(), baseline.end(),
+            [&result](const BenchResult & other) { return other.name == result.name; });
+        os << std::left << std::setw(40) << result.name << std::right;
+        if (base == baseline.end() || base->median_ns <= 0.0)
+        {
+            os << "  (not in baseline)\n";
+            continue;
+        }
+        double change = result.median_ns / base->median_ns - 1.0;
+        bool regressed = change > threshold;
+        regressions += regressed? 1 : 0;
+        os << std::setw(12) << base->median_ns / 1000.0 << " us ->"
+           << std::setw(12) << result.median_ns / 1000.0 << " us  "
+           << std::showpos << std::setw(7) << change * 100.0 << "%" << std::noshowpos
+           << (regressed? "  REGRESSION" : "") << "\n";
+    }
+    os.flags(flags);
+    return regressions;
+}
+
+} // namespace LCode
@@ -0,0 +1,155 @@
+/**
+ * @file    Benchmark.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   BenchmarkSuite class - A tiny microbenchmark harness. Each
+ *          benchmark body is timed run by run for a time budget and
+ *          summarized by its median, results can be written as JSON and
+ *          compared against a saved baseline to catch regressions.
+ *          The bench binary replaces the global `operator new` to count
+ *          heap allocations, so each result also reports allocations per
+ *          item.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_BENCHMARK_HPP
+#define LCODE_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+/**
+ * @return `size_t` Heap allocations made with `operator new` so far.
+ */
+size_t get_allocation_count();
+
+/**
+ * @brief Timings of one benchmark.
+ */
+struct BenchResult
+{
+    std::string name{};
+    // Items (cells, strings, ...) processed by one run of the body.
+    size_t items = 1;
+    // Number of timed runs.
+    size_t runs = 0;
+    // Median and fastest run in nanoseconds.
+    double median_ns = 0.0,
+           min_ns = 0.0;
+    // Average heap allocations made by one run of the body.
+    double allocs_per_run = 0.0;
+
+    double get_ns_per_item() const;
+    double get_allocs_per_item() const;
+};
+
+
+class BenchmarkSuite
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<BenchResult> results;
+    // only benchmarks with this in their name run
+    std::string filter;
+    // time spent running each benchmark, after one warm-up run
+    double min_seconds;
+    // cap on runs, for bodies with side effects that must not pile up
+    size_t default_max_runs;
+
+public:
+    // Fewest timed runs of a benchmark, however long they take.
+    static constexpr size_t MIN_RUNS = 5;
+
+    BenchmarkSuite(const std::string & name_filter = "", double seconds_per_bench = 0.5,
+                   size_t max_runs = 100'000);
+
+    /**
+     * @return true if a benchmark called `name` passes the filter.
+     */
+    bool is_selected(const std::string & name) const;
+
+    /**
+     * @brief Times `body()` over and over until the time budget or
+     *        `max_runs` is used up, and records the result.
+     *
+     * @param name     Unique name, also the key compared against baselines.
+     * @param items    Items processed by one call of `body`.
+     * @param max_runs Most runs (0 = the suite's default).
+     * @param body     The code to time.
+     */
+    template <typename Body>
+    void run(const std::string & name, size_t items, size_t max_runs, Body && body)
+    {
+        if (!is_selected(name))
+        {
+            return;
+        }
+        if (max_runs == 0)
+        {
+            max_runs = default_max_runs;
+        }
+        body();   // warm-up, fills caches and pools
+
+        std::vector<double> times;
+        // only allocations inside the body count, not the ones growing `times`
+        size_t allocs = 0;
+        Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(min_seconds));
+        while (times.size() < max_runs && (times.size() < MIN_RUNS || Clock::now() < end))
+        {
+            size_t allocs_before = get_allocation_count();
+            Clock::time_point start = Clock::now();
+            body();
+            Clock::time_point stop = Clock::now();
+            allocs += get_allocation_count() - allocs_before;
+            times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        record(name, items, times, allocs);
+    }
+
+    const std::vector<BenchResult> & get_results() const;
+
+    /**
+     * @brief Writes every result as a JSON document.
+     */
+    void write_json(std::ostream & os) const;
+
+    /**
+     * @brief Reads results written by `write_json()`.
+     *        Throws `LException` if the file can't be read.
+     */
+    static std::vector<BenchResult> read_json(const std::string & path);
+
+    /**
+     * @brief Prints each result next to the baseline result of the same
+     *        name, flagging medians slower than `1 + threshold` times the
+     *        baseline.
+     *
+     * @return `size_t` The number of regressions.
+     */
+    size_t compare(const std::vector<BenchResult> & baseline, double threshold,
+                   std::ostream & os) const;
+
+private:
+    void record(const std::string & name, size_t items, std::vector<double> & times,
+                size_t allocs);
+};
+
+std::ostream & operator << (std::ostream & os, const BenchResult & result);
+
+} // namespace LCode
+
+#endif // LCODE_BENCHMARK_HPP
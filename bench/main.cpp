@@ -0,0 +1,487 @@
+#include "Benchmark.hpp"
+#include "SDLBaseGame.hpp"
+#include "LException.hpp"
+#include "LTexture.hpp"
+#include "NutrientField.hpp"
+#include "lilyutils.hpp"
+#include "random.hpp"
+#include "entities/Cell.hpp"
+#include "entities/CellSwarm.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <algorithm>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+
+namespace
+{
+
+// Seed every benchmark starts from, so workloads match between runs.
+const std::uint64_t BENCH_SEED = 0xCE11;
+// Simulated ms per update, small enough that no cell dies during a benchmark.
+const double BENCH_DELTA_MS = 1.0;
+// Most runs of a benchmark that ages its cells, 2 simulated seconds.
+const size_t MAX_AGING_RUNS = 2000;
+
+/**
+ * @brief Bare game that exposes the entity loops to benchmark them
+ *        without a run loop.
+ */
+class BenchGame : public LCode::SDLBaseGame
+{
+public:
+    explicit BenchGame(bool headless_mode)
+    : SDLBaseGame(1280, 720, 16, headless_mode), nutrients{nullptr}
+    {
+        // update_entities() builds every entity's frame context from `delta`
+        delta = BENCH_DELTA_MS;
+    }
+
+    BenchGame(const BenchGame & other) = delete;
+    BenchGame & operator = (const BenchGame & other) = delete;
+
+    using SDLBaseGame::update_entities;
+    using SDLBaseGame::draw_entities;
+    using SDLBaseGame::remove_deleted_entities;
+    using SDLBaseGame::get_entities;
+
+    // entities feed from `field` while it isn't nullptr
+    void set_nutrients(const LCode::NutrientField * field)
+    {
+        nutrients = field;
+    }
+
+    void flip()
+    {
+        GPU_Flip(gpu);
+    }
+
+    void clear_entities()
+    {
+        for (LCode::LEntity * entity : get_entities())
+        {
+            delete_entity(entity);
+        }
+        remove_deleted_entities();
+    }
+
+protected:
+    void handle_event(SDL_Event &) override { }
+    void update() override { }
+    void draw() override { }
+
+    void fill_frame_context(LCode::FrameContext & context) override
+    {
+        context.nutrients = nutrients;
+    }
+
+private:
+    const LCode::NutrientField * nutrients;
+};
+
+std::string count_name(size_t count)
+{
+    if (count >= 1'000'000)
+    {
+        return std::to_string(count / 1'000'000) + "M";
+    }
+    if (count >= 1'000)
+    {
+        return std::to_string(count / 1'000) + "k";
+    }
+    return std::to_string(count);
+}
+
+void bench_updates(LCode::BenchmarkSuite & suite, BenchGame & game)
+{
+    for (size_t count : {1'000u, 10'000u, 100'000u, 1'000'000u})
+    {
+        std::string name = "update_entities/cells/" + count_name(count);
+        if (suite.is_selected(name))
+        {
+            LCode::set_rand_seed(BENCH_SEED);
+            for (size_t i = 0; i < count; ++i)
+            {
+                game.spawn<LCode::Cell>();
+            }
+            suite.run(name, count, MAX_AGING_RUNS, [&game] { game.update_entities(); });
+            game.clear_entities();
+        }
+
+        name = "update_entities/swarm/" + count_name(count);
+        if (suite.is_selected(name))
+        {
+            LCode::set_rand_seed(BENCH_SEED);
+            game.spawn<LCode::CellSwarm>()->add_random_cells(count);
+            suite.run(name, count, MAX_AGING_RUNS, [&game] { game.update_entities(); });
+            game.clear_entities();
+        }
+    }
+
+    // enough entities to fan out, the swarm still has to get every thread
+    static const size_t MIXED_CELLS = 10'000;
+    static const size_t MIXED_SWARM = 100'000;
+    const std::string mixed_name = "update_entities/cells+swarm/10k+100k";
+    if (suite.is_selected(mixed_name))
+    {
+        LCode::set_rand_seed(BENCH_SEED);
+        for (size_t i = 0; i < MIXED_CELLS; ++i)
+        {
+            game.spawn<LCode::Cell>();
+        }
+        game.spawn<LCode::CellSwarm>()->add_random_cells(MIXED_SWARM);
+        suite.run(mixed_name, MIXED_CELLS + MIXED_SWARM, MAX_AGING_RUNS,
+                  [&game] { game.update_entities(); });
+        game.clear_entities();
+    }
+}
+
+void bench_collisions(LCode::BenchmarkSuite & suite, BenchGame & game)
+{
+    // the screen is small, so this is already about 10 overlaps per cell
+    static const size_t CELLS = 1'000;
+    const std::string name = "update_entities/swarm+collide/1k";
+    if (!suite.is_selected(name))
+    {
+        return;
+    }
+    LCode::set_rand_seed(BENCH_SEED);
+    LCode::CellSwarm * swarm = game.spawn<LCode::CellSwarm>();
+    swarm->add_random_cells(CELLS);
+    swarm->set_collisions(true);
+    suite.run(name, CELLS, MAX_AGING_RUNS, [&game] { game.update_entities(); });
+    game.clear_entities();
+}
+
+void bench_nutrients(LCode::BenchmarkSuite & suite, BenchGame & game)
+{
+    // 1024 x 1024 grid cells at the default 32 px per grid cell
+    static const int WORLD_SIZE = 32'768;
+    static const size_t GRID_CELLS = 1'024 * 1'024;
+    for (bool simd : {true, false})
+    {
+        const std::string name = std::string{"nutrients/step/"}
+                                 + (simd? LCode::NutrientField::SIMD_NAME : "scalar") + "/1M";
+        if (!suite.is_selected(name))
+        {
+            continue;
+        }
+        LCode::NutrientField field;
+        field.resize(WORLD_SIZE, WORLD_SIZE);
+        field.set_simd(simd);
+        suite.run(name, GRID_CELLS, 0, [&field, &game]
+        {
+            field.step(BENCH_DELTA_MS, game.get_thread_pool());
+        });
+    }
+
+    // a swarm feeding from the field, against update_entities/swarm/100k
+    static const size_t CELLS = 100'000;
+    const std::string fed_name = "update_entities/swarm+nutrients/100k";
+    if (!suite.is_selected(fed_name))
+    {
+        return;
+    }
+    LCode::set_rand_seed(BENCH_SEED);
+    LCode::CellSwarm * swarm = game.spawn<LCode::CellSwarm>();
+    swarm->add_random_cells(CELLS);
+    LCode::NutrientField field;
+    const SDL_Rect & world = game.get_world_rect();
+    field.resize(world.w, world.h);
+    game.set_nutrients(&field);
+    suite.run(fed_name, CELLS, MAX_AGING_RUNS, [&game, &field, swarm]
+    {
+        field.clear_demand();
+        swarm->add_demand_to(field);
+        game.update_entities();
+        field.step(BENCH_DELTA_MS, game.get_thread_pool());
+    });
+    game.set_nutrients(nullptr);
+    game.clear_entities();
+}
+
+void bench_churn(LCode::BenchmarkSuite & suite, BenchGame & game)
+{
+    static const size_t CHURN = 1'000;
+    LCode::set_rand_seed(BENCH_SEED);
+
+    suite.run("churn/add_entity+delete_entity/1k", CHURN, 0, [&game]
+    {
+        for (size_t i = 0; i < CHURN; ++i)
+        {
+            game.add_entity(new LCode::Cell());
+        }
+        game.clear_entities();
+    });
+    suite.run("churn/spawn+delete_entity/1k", CHURN, 0, [&game]
+    {
+        for (size_t i = 0; i < CHURN; ++i)
+        {
+            game.spawn<LCode::Cell>();
+        }
+        game.clear_entities();
+    });
+}
+
+void bench_formatting(LCode::BenchmarkSuite & suite)
+{
+    static const size_t VALUES = 1'000;
+    static const char * const NAMES[] = {
+        "format/round_to/1k", "format/label/string/1k", "format/label/text_buffer/1k",
+        "format/hud/string/1k", "format/hud/text_buffer/1k"
+    };
+    if (std::none_of(std::begin(NAMES), std::end(NAMES),
+                     [&suite](const char * name) { return suite.is_selected(name); }))
+    {
+        return;
+    }
+    std::vector<double> values(VALUES);
+    LCode::set_rand_seed(BENCH_SEED);
+    LCode::rand_floats(values.data(), values.size(), 0.0, 20.0);
+
+    size_t total_length = 0;
+    suite.run("format/round_to/1k", VALUES, 0, [&]
+    {
+        for (double value : values)
+        {
+            total_length += LCode::round_to(value, 1).size();
+        }
+    });
+    // the "HP: x / y" cell label, built the way it used to be and on the stack
+    suite.run("format/label/string/1k", VALUES, 0, [&]
+    {
+        for (double value : values)
+        {
+            std::string label = "HP: " + LCode::round_to(value, 1) + " / "
+                                + LCode::round_to(value * 2.0, 1);
+            total_length += label.size();
+        }
+    });
+    suite.run("format/label/text_buffer/1k", VALUES, 0, [&]
+    {
+        for (double value : values)
+        {
+            LCode::TextBuffer<LCode::Cell::LABEL_CAPACITY> label;
+            label.append("HP: ").append(value, 1).append(" / ").append(value * 2.0, 1);
+            total_length += label.size();
+        }
+    });
+    // a HUD line, too long for the small string buffer of std::string
+    suite.run("format/hud/string/1k", VALUES, 0, [&]
+    {
+        for (double value : values)
+        {
+            std::string line = "Current FPS: " + LCode::round_to(value * 3.0, 1)
+                               + " (target 60, jitter " + LCode::round_to(value, 2) + " ms)";
+            total_length += line.size();
+        }
+    });
+    suite.run("format/hud/text_buffer/1k", VALUES, 0, [&]
+    {
+        for (double value : values)
+        {
+            LCode::TextBuffer<128> line;
+            line.append("Current FPS: ").append(value * 3.0, 1)
+                .append(" (target 60, jitter ").append(value, 2).append(" ms)");
+            total_length += line.size();
+        }
+    });
+    // keeps the loops from being optimized away
+    if (total_length == 0)
+    {
+        std::cout << "round_to produced no text!\n";
+    }
+}
+
+void bench_display(LCode::BenchmarkSuite & suite, BenchGame & game)
+{
+    LCode::LTexture texture;
+    size_t frame = 0;
+    suite.run("texture/load_text", 1, 0, [&]
+    {
+        texture.load_text("Current FPS: " + std::to_string(frame++));
+    });
+    // the same text again while the first texture still holds it is a cache hit
+    LCode::LTexture repeated;
+    suite.run("texture/load_text/cached", 1, 0, [&]
+    {
+        repeated.load_text("Current FPS: " + std::to_string(frame - 1));
+    });
+    // copies share the image instead of loading it again
+    std::vector<LCode::LTexture> copies;
+    suite.run("texture/copy/1k", 1'000, 0, [&]
+    {
+        copies.assign(1'000, texture);
+    });
+
+    for (size_t count : {1'000u, 10'000u})
+    {
+        std::string name = "draw_entities/cells/" + count_name(count);
+        if (!suite.is_selected(name))
+        {
+            continue;
+        }
+        LCode::set_rand_seed(BENCH_SEED);
+        for (size_t i = 0; i < count; ++i)
+        {
+            game.spawn<LCode::Cell>();
+        }
+        // the flip is included so the batched triangles are actually submitted
+        suite.run(name, count, 0, [&game]
+        {
+            game.draw_entities();
+            game.flip();
+        });
+        game.clear_entities();
+    }
+
+    // a world 400 times the screen, only the cells in view are drawn
+    static const size_t WORLD_CELLS = 100'000;
+    const std::string culled_name = "draw_entities/cells/100k_world_20000x20000";
+    if (suite.is_selected(culled_name))
+    {
+        game.set_world_size(20'000, 20'000);
+        LCode::set_rand_seed(BENCH_SEED);
+        for (size_t i = 0; i < WORLD_CELLS; ++i)
+        {
+            game.spawn<LCode::Cell>();
+        }
+        suite.run(culled_name, WORLD_CELLS, 0, [&game]
+        {
+            game.draw_entities();
+            game.flip();
+        });
+        game.clear_entities();
+        game.set_world_size(0, 0);
+    }
+}
+
+void print_usage(const char * program)
+{
+    std::cout << "Usage: " << program << " [--filter TEXT] [--time S] [--json FILE]\n"
+                 "       [--baseline FILE] [--threshold F] [--display] [--threads N]\n"
+              << "  --filter TEXT    only run benchmarks with TEXT in their name\n"
+              << "  --time S         seconds to run each benchmark for (default 0.5)\n"
+              << "  --json FILE      write the results to FILE as JSON\n"
+              << "  --baseline FILE  compare against results saved with --json and\n"
+              << "                   fail if any is slower than the threshold\n"
+              << "  --threshold F    allowed slowdown before failing (default 0.10)\n"
+              << "  --display        also benchmark text rendering and drawing\n"
+              << "                   (needs a window and GPU)\n"
+              << "  --threads N      threads to update entities with (default 1)\n";
+}
+
+} // namespace
+
+
+int main(int argc, char * argv[])
+{
+    std::string filter;
+    double seconds = 0.5;
+    std::string json_path;
+    std::string baseline_path;
+    double threshold = 0.10;
+    bool display = false;
+    size_t threads = 1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg{argv[i]};
+        bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--time" && has_value)
+        {
+            seconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--json" && has_value)
+        {
+            json_path = argv[++i];
+        }
+        else if (arg == "--baseline" && has_value)
+        {
+            baseline_path = argv[++i];
+        }
+        else if (arg == "--threshold" && has_value)
+        {
+            threshold = std::atof(argv[++i]);
+        }
+        else if (arg == "--display")
+        {
+            display = true;
+        }
+        else if (arg == "--threads" && has_value)
+        {
+            threads = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    LCode::BenchmarkSuite suite{filter, seconds};
+    std::vector<LCode::BenchResult> baseline;
+    try
+    {
+        // read the baseline first so a bad path fails before the long part
+        if (!baseline_path.empty())
+        {
+            baseline = LCode::BenchmarkSuite::read_json(baseline_path);
+        }
+        // headless or not, only one game can exist at a time
+        {
+            BenchGame game{!display};
+            game.set_update_threads(threads);
+            bench_updates(suite, game);
+            bench_collisions(suite, game);
+            bench_nutrients(suite, game);
+            bench_churn(suite, game);
+            if (display)
+            {
+                bench_display(suite, game);
+            }
+        }
+        bench_formatting(suite);
+    }
+    catch (const LCode::LException & e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    if (!json_path.empty())
+    {
+        std::ofstream file{json_path};
+        suite.write_json(file);
+        if (!file)
+        {
+            std::cerr << "Unable to write \"" << json_path << "\"!\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (!baseline_path.empty())
+    {
+        std::cout << "---- compared to " << baseline_path << " ----\n";
+        size_t regressions = suite.compare(baseline, threshold, std::cout);
+        if (regressions > 0)
+        {
+            std::cout << regressions << " benchmark(s) regressed by more than "
+                      << threshold * 100.0 << "%\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
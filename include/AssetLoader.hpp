@@ -0,0 +1,115 @@
+/**
+ * @file    AssetLoader.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   AssetLoader class - Opens fonts and decodes images on background
+ *          threads, so startup can create the window and GPU context while
+ *          they load. SDL_ttf and SDL_image are only initialized the first
+ *          time a font or image is actually requested.
+ *
+ *          Image files are only decoded into an `SDL_Surface` off the main
+ *          thread, uploading them to the GPU has to happen on the thread
+ *          that owns the GPU context.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_ASSETLOADER_HPP
+#define LCODE_ASSETLOADER_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <future>
+#include <mutex>
+#include <string>
+
+namespace LCode
+{
+
+/**
+ * @brief An asset loaded in the background, and how long loading it took
+ *        on its own thread.
+ */
+template <typename AssetT>
+struct LoadedAsset
+{
+    AssetT * asset = nullptr;
+    double load_ms = 0.0;
+};
+
+using LoadedFont = LoadedAsset<TTF_Font>;
+using LoadedSurface = LoadedAsset<SDL_Surface>;
+
+
+class AssetLoader
+{
+    // guards the lazy subsystem initialization, loads may race to it
+    std::mutex init_mutex;
+    bool ttf_initialized;
+    bool image_initialized;
+
+public:
+    AssetLoader();
+
+    AssetLoader(const AssetLoader & other) = delete;
+    AssetLoader & operator = (const AssetLoader & other) = delete;
+
+    /**
+     * @brief Shuts down whatever subsystems were initialized.
+     *        Everything loaded has to be freed first.
+     */
+    ~AssetLoader();
+
+    /**
+     * @brief Opens the font at `path` at `point_size` on a background thread.
+     *        `get()` on the result rethrows an `LException` if it failed.
+     *        The caller closes the font with `TTF_CloseFont`.
+     */
+    std::future<LoadedFont> load_font_async(const std::string & path, int point_size);
+
+    /**
+     * @brief Decodes the image at `path` on a background thread.
+     *        `get()` on the result rethrows an `LException` if it failed.
+     *        The caller frees the surface with `SDL_FreeSurface`.
+     */
+    std::future<LoadedSurface> load_surface_async(const std::string & path);
+
+    /**
+     * @brief Opens a font right away, on the calling thread.
+     *        Throws `LException` if it can't be opened.
+     */
+    LoadedFont load_font(const std::string & path, int point_size);
+
+    /**
+     * @brief Decodes an image right away, on the calling thread.
+     *        Throws `LException` if it can't be decoded.
+     */
+    LoadedSurface load_surface(const std::string & path);
+
+    /**
+     * @brief Initializes SDL_ttf / SDL_image unless they already are.
+     *        Safe to call from any thread. Throws `LException` on failure.
+     */
+    void require_ttf();
+    void require_image();
+
+    bool is_ttf_initialized();
+    bool is_image_initialized();
+
+    /**
+     * @brief Shuts down whatever subsystems were initialized, so the next
+     *        request initializes them again.
+     */
+    void quit();
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_ASSETLOADER_HPP
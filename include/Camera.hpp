@@ -0,0 +1,94 @@
+/**
+ * @file    Camera.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   Camera class - The part of the world shown in the window. Keeps
+ *          a center point in world coordinates and a zoom factor, converts
+ *          between screen and world coordinates and makes the `GPU_Camera`
+ *          entities are drawn through.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_CAMERA_HPP
+#define LCODE_CAMERA_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+namespace LCode
+{
+
+class Camera
+{
+    // world position shown in the middle of the view
+    SDL_FPoint center;
+    // screen pixels per world unit
+    float zoom;
+    // size of the view on screen, in pixels
+    float view_w, view_h;
+
+public:
+    static inline const float MIN_ZOOM = 1.0f / 64.0f;
+    static inline const float MAX_ZOOM = 8.0f;
+
+    Camera();
+
+    /**
+     * @brief Sets the size of the view on screen (the window size).
+     */
+    void set_viewport(int width, int height);
+
+    void look_at(SDL_FPoint world_pos);
+    SDL_FPoint get_center() const;
+
+    /**
+     * @brief Moves the view by the given number of screen pixels.
+     */
+    void pan(float screen_dx, float screen_dy);
+
+    void set_zoom(float new_zoom);
+    float get_zoom() const;
+
+    /**
+     * @brief Multiplies the zoom by `factor` while keeping the world point
+     *        under the screen position (`screen_x`, `screen_y`) in place,
+     *        like zooming towards the mouse.
+     */
+    void zoom_at(float factor, float screen_x, float screen_y);
+
+    /**
+     * @brief Zooms and centers the view so all of `world` is visible.
+     */
+    void fit(const SDL_Rect & world);
+
+    /**
+     * @brief Keeps the center of the view inside `world`.
+     */
+    void clamp_to(const SDL_Rect & world);
+
+    /**
+     * @return `SDL_FRect` The part of the world that is visible, in world
+     *         coordinates.
+     */
+    SDL_FRect get_view() const;
+
+    SDL_FPoint world_to_screen(SDL_FPoint world_pos) const;
+    SDL_FPoint screen_to_world(SDL_FPoint screen_pos) const;
+
+    /**
+     * @return `GPU_Camera` The camera to pass to `GPU_SetCamera` so world
+     *         coordinates are drawn where `world_to_screen()` puts them.
+     */
+    GPU_Camera to_gpu_camera() const;
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_CAMERA_HPP
@@ -0,0 +1,149 @@
+/**
+ * @file    CullGrid.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   CullGrid class - Square buckets over the world holding the
+ *          entities whose position is inside them, so drawing only looks
+ *          at the buckets in view instead of at every entity. Unlike
+ *          `SpatialGrid` it is kept up to date in place: checking an entity
+ *          after it moved is a few float operations on its position, it
+ *          only changes bucket when it crosses into another one (a swap
+ *          and a pop), and nothing is rebuilt per frame.
+ *
+ *          Entities with bounds larger than a bucket when they are inserted
+ *          are kept in a list of their own and tested against the view one
+ *          by one.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_CULLGRID_HPP
+#define LCODE_CULLGRID_HPP
+
+#include "LEntity.hpp"
+#include "lilyutils.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+class CullGrid
+{
+public:
+    // `LEntity::cull_bucket` of entities that aren't in the grid.
+    static constexpr std::int32_t NOT_ADDED = -2;
+    // `LEntity::cull_bucket` of entities too large for a bucket.
+    static constexpr std::int32_t LARGE = -1;
+
+private:
+    // side length of a bucket, and its inverse to avoid dividing
+    float cell_size;
+    float inv_cell_size;
+    int columns, rows;
+    // last column and row as floats, for `grid_index()`
+    float max_column, max_row;
+    // the entities positioned in each bucket, row-major, in no particular order
+    std::vector<std::vector<LEntity *>> buckets;
+    // entities too large for a bucket
+    std::vector<LEntity *> large;
+    // handed to each inserted entity, so found entities can be put back
+    // in the order they were added (the order they are drawn in)
+    std::uint64_t next_order;
+    size_t count;
+
+public:
+    /**
+     * @param bucket_size Side length of a bucket, entities with bounds
+     *                    larger than this go in the large list.
+     */
+    explicit CullGrid(float bucket_size);
+    ~CullGrid();
+
+    /**
+     * @brief Covers a `width` by `height` world, moving every entity to its
+     *        new bucket if that changes the grid size.
+     */
+    void resize(float width, float height);
+
+    /**
+     * @brief Adds `entity` to the bucket of its position, or to the large
+     *        list if its bounds are larger than a bucket, after every
+     *        entity added before it in the draw order.
+     */
+    void insert(LEntity * entity);
+
+    /**
+     * @brief Takes `entity` out of the grid, does nothing if it isn't in it.
+     */
+    void remove(LEntity * entity);
+
+    /**
+     * @brief Forgets every entity, without touching them.
+     */
+    void clear();
+
+    /**
+     * @return `bool` True if `entity` is in a bucket but its position is in
+     *         another one now. Only reads, so update threads can call it
+     *         while nothing is inserted or removed.
+     */
+    bool has_moved(const LEntity & entity) const
+    {
+        return entity.cull_bucket >= 0
+               && bucket_of(entity.pos.x, entity.pos.y) != entity.cull_bucket;
+    }
+
+    /**
+     * @brief Moves `entity` to the bucket its position is in now.
+     */
+    void refresh(LEntity * entity)
+    {
+        if (has_moved(*entity))
+        {
+            move(entity, bucket_of(entity->pos.x, entity->pos.y));
+        }
+    }
+
+    /**
+     * @brief Fills `out` with the entities not deleted whose bounds overlap
+     *        `view`, in the order they were inserted.
+     */
+    void find_visible(const SDL_FRect & view, std::vector<LEntity *> & out) const;
+
+    /**
+     * @return `size_t` The number of entities in the grid.
+     */
+    size_t size() const;
+
+private:
+    std::int32_t bucket_of(float x, float y) const
+    {
+        int column = grid_index(x, inv_cell_size, max_column);
+        int row = grid_index(y, inv_cell_size, max_row);
+        return static_cast<std::int32_t>(row * columns + column);
+    }
+
+    // The bucket `entity` belongs in, or `LARGE`.
+    std::int32_t classify(const LEntity & entity) const;
+    std::vector<LEntity *> & list_of(std::int32_t bucket);
+
+    void move(LEntity * entity, std::int32_t bucket);
+    void place(LEntity * entity, std::int32_t bucket);
+    void unplace(LEntity * entity);
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_CULLGRID_HPP
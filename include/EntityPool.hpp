@@ -0,0 +1,169 @@
+/**
+ * @file    EntityPool.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   EntityPool class - Typed slab allocator for `LEntity` subclasses.
+ *          Each entity type gets its own `EntitySlab` of fixed-size blocks
+ *          allocated in contiguous chunks, with a free list so the blocks
+ *          of dead entities are recycled by the next spawn of that type.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_ENTITYPOOL_HPP
+#define LCODE_ENTITYPOOL_HPP
+
+#include "LEntity.hpp"
+
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+/**
+ * @brief Occupancy numbers for one `EntitySlab` (or the totals of a pool).
+ */
+struct SlabStats
+{
+    std::string type_name{};
+    // size of one block in bytes
+    size_t block_size = 0;
+    // blocks currently holding a live entity
+    size_t in_use = 0;
+    // blocks allocated in total (used + free)
+    size_t capacity = 0;
+    // highest `in_use` seen since the slab was created
+    size_t high_water = 0;
+};
+
+std::ostream & operator << (std::ostream & os, const SlabStats & stats);
+
+
+class EntitySlab
+{
+    // singly-linked free list threaded through the unused blocks
+    struct FreeBlock
+    {
+        FreeBlock * next;
+    };
+
+    std::vector<void *> chunks;
+    FreeBlock * free_list;
+    SlabStats stats;
+    size_t alignment;
+    size_t blocks_per_chunk;
+
+public:
+    /**
+     * @param type_name        Name of the type stored, used in stats.
+     * @param block_size       `sizeof` the stored type.
+     * @param block_alignment  `alignof` the stored type.
+     * @param chunk_blocks     How many blocks to allocate at once when empty.
+     */
+    EntitySlab(std::string type_name, size_t block_size, size_t block_alignment,
+               size_t chunk_blocks = 1024);
+
+    // Blocks are handed out by address, so the slab can't be copied
+    EntitySlab(const EntitySlab & other) = delete;
+    EntitySlab & operator = (const EntitySlab & other) = delete;
+
+    ~EntitySlab();
+
+    /**
+     * @return `void *` An uninitialized block of `block_size` bytes.
+     */
+    void * allocate();
+
+    /**
+     * @brief Returns a block (whose object was already destroyed) to the free list.
+     */
+    void release(void * block);
+
+    const SlabStats & get_stats() const;
+
+private:
+    void grow();
+};
+
+
+class EntityPool
+{
+    std::unordered_map<std::type_index, std::unique_ptr<EntitySlab>> slabs;
+
+public:
+    EntityPool();
+
+    EntityPool(const EntityPool & other) = delete;
+    EntityPool & operator = (const EntityPool & other) = delete;
+
+    /**
+     * @brief Constructs a new `EntityT` inside its type's slab.
+     *        The returned entity must be destroyed with `destroy()`.
+     */
+    template <typename EntityT, typename... Args>
+    EntityT * create(Args &&... args);
+
+    /**
+     * @brief Destroys an entity and recycles its block. Entities that were
+     *        not created by a pool (plain `new`) are `delete`d instead.
+     */
+    static void destroy(LEntity * entity);
+
+    /**
+     * @return `std::vector<SlabStats>` Stats of every slab, one per entity type.
+     */
+    std::vector<SlabStats> get_stats() const;
+
+    /**
+     * @return `SlabStats` The sum of every slab's stats (`block_size` is the
+     *         total number of bytes reserved by the pool).
+     */
+    SlabStats get_total_stats() const;
+
+private:
+    EntitySlab & get_slab(const std::type_info & type, size_t size, size_t align);
+};
+
+std::ostream & operator << (std::ostream & os, const EntityPool & pool);
+
+
+template <typename EntityT, typename... Args>
+EntityT * EntityPool::create(Args &&... args)
+{
+    static_assert(std::is_base_of<LEntity, EntityT>::value,
+                  "EntityPool can only create LEntity subclasses!");
+
+    EntitySlab & slab = get_slab(typeid(EntityT), sizeof(EntityT), alignof(EntityT));
+    void * block = slab.allocate();
+    EntityT * entity = nullptr;
+    try
+    {
+        entity = new (block) EntityT(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        slab.release(block);
+        throw;
+    }
+    entity->slab = &slab;
+    return entity;
+}
+
+} // namespace LCode
+
+#endif // LCODE_ENTITYPOOL_HPP
@@ -0,0 +1,97 @@
+/**
+ * @file    FrameContext.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   Everything an entity needs to know about the current tick,
+ *          built once per tick by `SDLBaseGame` and passed to every
+ *          `LEntity::update()`. Entities read it instead of asking the
+ *          game or SDL, so updates only touch local data and work the
+ *          same on worker threads and headless.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_FRAMECONTEXT_HPP
+#define LCODE_FRAMECONTEXT_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+class NutrientField;
+
+/**
+ * @brief Things the player can do, each mapped to a key by the game.
+ */
+enum class InputAction
+{
+    // Entities move twice as fast while held.
+    SPEED_BOOST,
+    COUNT
+};
+
+/**
+ * @brief Which actions were held when the tick started.
+ */
+struct InputSnapshot
+{
+    std::array<bool, static_cast<size_t>(InputAction::COUNT)> actions{};
+
+    bool is_active(InputAction action) const
+    {
+        return actions[static_cast<size_t>(action)];
+    }
+};
+
+/**
+ * @brief What entities changed while updating, added up by each update
+ *        thread on its own and merged once they are all done, so running
+ *        totals don't need a pass over every entity.
+ */
+struct UpdateTally
+{
+    // Individual cells that ran out of life.
+    std::uint64_t cell_deaths = 0;
+    // Seconds of life individual cells gained (fed) or lost (decayed or died).
+    double life_change = 0.0;
+
+    UpdateTally & operator += (const UpdateTally & other)
+    {
+        cell_deaths += other.cell_deaths;
+        life_change += other.life_change;
+        return *this;
+    }
+};
+
+/**
+ * @brief The state of one simulation tick, the same for every entity.
+ */
+struct FrameContext
+{
+    // Milliseconds this tick simulates.
+    double delta_ms = 0.0;
+    // The area entities live in, starting at (0, 0).
+    SDL_Rect world{0, 0, 0, 0};
+    InputSnapshot input{};
+    // The field entities feed from, nullptr without one. Only read during
+    // updates, it is stepped after every entity was updated.
+    const NutrientField * nutrients = nullptr;
+    // Where the updating thread adds up what entities changed, never
+    // nullptr while `SDLBaseGame` updates its entities.
+    UpdateTally * tally = nullptr;
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_FRAMECONTEXT_HPP
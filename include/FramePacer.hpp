@@ -0,0 +1,107 @@
+/**
+ * @file    FramePacer.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   FramePacer class - Holds the run loop to a target frame time.
+ *          It sleeps while the next frame is far away and spins through
+ *          the last millisecond or two, since the OS can oversleep by that
+ *          much, so the CPU idles without frames arriving late. Also
+ *          measures how far actual frame times stray from the target.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_FRAMEPACER_HPP
+#define LCODE_FRAMEPACER_HPP
+
+#include "LTimer.hpp"
+
+#include <iostream>
+#include <cstddef>
+
+namespace LCode
+{
+
+/**
+ * @brief Frame time measurements collected by a `FramePacer`.
+ */
+struct PacingStats
+{
+    // Frames paced since the stats were last reset.
+    size_t frames = 0;
+    // Frame time aimed for in ms (0 = unlimited).
+    double target_ms = 0.0;
+    // Sum of every frame time in ms.
+    double total_frame_ms = 0.0;
+    // Sum and largest of |frame time - target| in ms.
+    double total_jitter_ms = 0.0;
+    double max_jitter_ms = 0.0;
+    // Jitter averaged over roughly the last second of frames.
+    double recent_jitter_ms = 0.0;
+    // Time spent waiting for the next frame, asleep and spinning.
+    double slept_ms = 0.0;
+    double spun_ms = 0.0;
+
+    double get_mean_frame_ms() const;
+    double get_mean_jitter_ms() const;
+};
+
+std::ostream & operator << (std::ostream & os, const PacingStats & stats);
+
+
+class FramePacer
+{
+    // Shortest and longest time before a deadline that sleeping stops.
+    static inline const double MIN_SPIN_MARGIN_MS = 1.0;
+    static inline const double MAX_SPIN_MARGIN_MS = 4.0;
+
+    // frame time aimed for, 0 when unlimited
+    double target_ms;
+    // time on the timer the next frame is due
+    double next_frame_ms;
+    // time on the timer the last frame was let through
+    double last_frame_ms;
+    // sleep stops this far before the deadline and spins the rest, grows
+    // when the OS oversleeps and shrinks slowly back towards the minimum
+    double spin_margin_ms;
+
+    PacingStats stats;
+
+public:
+    FramePacer();
+
+    /**
+     * @brief Sets the frames per second to pace to, 0 for unlimited.
+     */
+    void set_target_fps(double fps);
+
+    /**
+     * @brief Sets the frame time to pace to in ms, 0 for unlimited.
+     */
+    void set_target_frame_ms(double frame_ms);
+
+    double get_target_frame_ms() const;
+
+    /**
+     * @brief Starts pacing from `now_ms` on the timer passed to `wait()`.
+     *        Call when the run loop starts, also resets the stats.
+     */
+    void reset(double now_ms);
+
+    /**
+     * @brief Waits until the next frame is due on `timer` and records how
+     *        long this frame took. Returns immediately when unlimited.
+     */
+    void wait(LTimer & timer);
+
+    const PacingStats & get_stats() const;
+};
+
+} // namespace LCode
+
+#endif // LCODE_FRAMEPACER_HPP
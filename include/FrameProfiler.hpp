@@ -0,0 +1,158 @@
+/**
+ * @file    FrameProfiler.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   FrameProfiler class - Times each phase of the run loop and keeps
+ *          the last few hundred frames in a ring buffer, so percentiles of
+ *          every phase can be shown while running and the raw frames can
+ *          be dumped to CSV, without an external profiler.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_FRAMEPROFILER_HPP
+#define LCODE_FRAMEPROFILER_HPP
+
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+/**
+ * @brief The timed phases of a frame. `UPDATE_ENTITIES` runs inside
+ *        `UPDATE` and `DRAW_ENTITIES` inside `DRAW`, so they overlap.
+ *        `FRAME` is the whole time from one frame's end to the next.
+ */
+enum class FramePhase
+{
+    EVENTS,
+    SYSTEM_UPDATE,
+    UPDATE,
+    UPDATE_ENTITIES,
+    DRAW,
+    DRAW_ENTITIES,
+    FLIP,
+    PACING,
+    FRAME,
+    COUNT
+};
+
+const char * to_string(FramePhase phase);
+
+/**
+ * @brief Percentiles of one phase over the recorded frames, in ms.
+ */
+struct PhaseSummary
+{
+    double p50 = 0.0,
+           p95 = 0.0,
+           p99 = 0.0,
+           max = 0.0;
+};
+
+
+class FrameProfiler
+{
+public:
+    static const size_t PHASE_COUNT = static_cast<size_t>(FramePhase::COUNT);
+    // Frames kept by default, 10 seconds at 60 FPS.
+    static const size_t DEFAULT_CAPACITY = 600;
+
+    // Milliseconds spent in each phase during one frame.
+    using FrameTimes = std::array<double, PHASE_COUNT>;
+
+    /**
+     * @brief Adds the time from its construction to its destruction to
+     *        a phase of the current frame.
+     */
+    class Scope
+    {
+        FrameProfiler & profiler;
+        FramePhase phase;
+        Uint64 start;
+
+    public:
+        Scope(FrameProfiler & frame_profiler, FramePhase timed_phase);
+        Scope(const Scope & other) = delete;
+        Scope & operator = (const Scope & other) = delete;
+        ~Scope();
+    };
+
+private:
+    // ring buffer of the last `frames.size()` finished frames
+    std::vector<FrameTimes> frames;
+    // where the next finished frame is written in `frames`
+    size_t next_frame;
+    // number of finished frames in `frames`, up to its size
+    size_t recorded;
+    // total frames finished, including ones overwritten in the ring
+    size_t total_frames;
+    // performance counter when the last frame ended, `FRAME` is measured from it
+    Uint64 last_frame_end;
+    // the frame being timed
+    FrameTimes current;
+    bool enabled;
+    // scratch space for sorting one phase when summarizing
+    std::vector<double> sorted;
+
+public:
+    explicit FrameProfiler(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Turns timing on or off, `Scope`s do nothing while off.
+     */
+    void set_enabled(bool enable);
+    bool is_enabled() const;
+
+    /**
+     * @brief Adds `ms` to `phase` in the current frame. Phases timed more
+     *        than once a frame (e.g. several update ticks) add up.
+     */
+    void add(FramePhase phase, double ms);
+
+    /**
+     * @brief Stores the current frame in the ring buffer and starts a new
+     *        one. The `FRAME` phase is the time since the last call.
+     */
+    void end_frame();
+
+    /**
+     * @brief Forgets every recorded frame, the next `FRAME` is timed from now.
+     */
+    void clear();
+
+    /**
+     * @return `size_t` Frames currently held in the ring buffer.
+     */
+    size_t get_recorded_frames() const;
+
+    /**
+     * @brief Computes the percentiles of `phase` over the recorded frames.
+     */
+    PhaseSummary summarize(FramePhase phase);
+
+    /**
+     * @brief Writes the recorded frames to a CSV file, oldest first, one
+     *        column per phase in ms.
+     *
+     * @return true if the file was written.
+     */
+    bool write_csv(const std::string & path) const;
+
+private:
+    const FrameTimes & get_frame(size_t age) const;
+};
+
+} // namespace LCode
+
+#endif // LCODE_FRAMEPROFILER_HPP
@@ -5,32 +5,130 @@
 #include <SDLBaseGame.hpp>
 #include "LTexture.hpp"
 #include "LEntity.hpp"
+#include "HudText.hpp"
+#include "SpatialGrid.hpp"
+#include "NutrientField.hpp"
+#include "entities/Cell.hpp"
+#include "entities/CellSwarm.hpp"
+#include "entities/CellSpriteCache.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
-#include <sstream>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 
 
 namespace LCode
 {
 
+/**
+ * @brief Startup options for `Game`, filled in from the command line.
+ */
+struct GameOptions
+{
+    // Run without a window (see `SDLBaseGame::run_headless()`), starts
+    // unpaused and skips all text textures.
+    bool headless = false;
+    // The number of individual `Cell` entities to spawn at startup.
+    size_t cells = 1;
+    // The number of cells to spawn into the `CellSwarm` at startup.
+    size_t swarm_cells = 0;
+    // Threads to update entities with (0 = every hardware thread).
+    size_t update_threads = 0;
+    // How cells are drawn at startup (R switches while running).
+    CellRenderMode render_mode = CellRenderMode::GEOMETRY;
+    // Fixed simulation ticks per second, independent of the frame rate.
+    double tick_rate = SDLBaseGame::DEFAULT_TICK_RATE;
+    // Most ticks simulated per frame before the game slows down instead.
+    int max_ticks_per_frame = SDLBaseGame::DEFAULT_MAX_TICKS_PER_FRAME;
+    // Frames per second to pace drawing to (0 = unlimited),
+    // unset paces to `Game::SCREEN_FPS`.
+    std::optional<double> target_fps{};
+    // Wait for the display refresh when flipping.
+    bool vsync = false;
+    // Random seed to create the game with, unset seeds from the clock.
+    std::optional<std::uint64_t> seed{};
+    // Start paused, unset starts paused unless headless.
+    std::optional<bool> start_paused{};
+    // Push overlapping cells apart (C toggles while running).
+    bool collisions = false;
+    // Cells feed from a diffusing nutrient field (N toggles while running).
+    bool nutrients = false;
+    // Size of the world cells live in, 0 to use the window size.
+    int world_width = 0,
+        world_height = 0;
+    // On-screen radii where cells switch to less detailed drawing.
+    CellLodThresholds lod{};
+    // Snapshot file to start from instead of spawning `cells` and
+    // `swarm_cells` (see `Game::load_snapshot()`), empty to spawn them.
+    std::string snapshot{};
+};
+
 class Game : public SDLBaseGame
 {
     // Textures
-    LTexture fps_avg_texture,
-             fps_cur_texture,
-             load_time_texture,
+    LTexture load_time_texture,
              press_spacebar_texture,
              press_a_texture,
-             entity_count_texture;
+             press_s_texture,
+             press_r_texture,
+             press_p_texture,
+             press_c_texture,
+             press_view_texture,
+             press_snapshot_texture,
+             press_n_texture;
+
+    // HUD text that changes while running
+    HudText fps_avg_text,
+            fps_cur_text,
+            entity_count_text,
+            batch_stats_text,
+            view_text,
+            lod_text,
+            nutrients_text;
+
+    // Structure-of-arrays store for mass cell simulation, created on first use
+    CellSwarm * swarm;
+    // whether the swarm uses its SIMD update kernel
+    bool swarm_simd;
+
+    // Cell collisions: individual cells are bucketed into `cell_grid` from
+    // the positions gathered in `grid_x/y` every tick (the swarm keeps its own)
+    bool collisions;
+    SpatialGrid cell_grid;
+    std::vector<Cell *> grid_cells;
+    std::vector<float> grid_x, grid_y;
+    // overlapping pairs of individual cells separated during the last tick
+    size_t cell_overlaps;
+
+    // Cells gain life from the field, which is stepped after every tick
+    // while enabled and sized to the world before every tick
+    NutrientField nutrients;
+    bool nutrients_enabled;
+
+    // the swarm, its size and its dead cells at the last telemetry record,
+    // to count swarm births and deaths
+    const CellSwarm * telemetry_swarm;
+    size_t telemetry_swarm_cells;
+    std::uint64_t telemetry_swarm_died;
+    // individual cells and their life added up, as of the last telemetry
+    // record plus the cells spawned since
+    size_t cell_count;
+    double cell_life;
+
+    // Frame profile overlay, one line per phase, rebuilt every FPS_REFRESH_MS
+    std::vector<std::string> profile_lines;
+    double profile_updated_ms;
+    bool show_profile;
 
     // Game Variables
     bool paused;
     bool space_pressed;
-    std::stringstream time_text_avg;
-    std::stringstream time_text_cur;
 
 public:
     // inline initialization of static variables
@@ -41,15 +139,118 @@ public:
     static inline const int FONT_SIZE = 22;
     static inline const SDL_Color TEXT_COLOR{0, 0, 0, 255};
     static inline const int TEXT_PADDING = 6;
+    // How often the HUD regenerates its FPS and entity count text (ms)
+    static inline const double FPS_REFRESH_MS = 250.0;
+    static inline const double COUNT_REFRESH_MS = 100.0;
+    // Characters a HUD line is built in, on the stack
+    static inline const size_t HUD_TEXT_CAPACITY = 128;
+    // Screen pixels per second the arrow keys move the view
+    static inline const double CAMERA_PAN_SPEED = 800.0;
+    // Zoom factor of one +/- press or mouse wheel notch
+    static inline const float CAMERA_ZOOM_STEP = 1.25f;
+    // Snapshot file F5 saves to and F9 loads from
+    static inline const char * const QUICKSAVE_PATH = "quicksave.lsnap";
+
+    Game(const GameOptions & options = GameOptions{});
+
+    // Don't allow copying
+    Game(const Game & other) = delete;
+    Game & operator = (const Game & other) = delete;
+
+    ~Game() override;
+
+    /**
+     * @return `size_t` The number of cells in the swarm (0 if there is none).
+     */
+    size_t get_swarm_size() const;
+
+    /**
+     * @brief Switches the swarm between its SIMD and scalar update kernels.
+     */
+    void set_swarm_simd(bool enabled);
 
-    Game();
+    bool is_paused() const;
+
+    /**
+     * @brief Turns pushing overlapping cells apart on or off, for both
+     *        individual cells and the swarm.
+     */
+    void set_collisions(bool enabled);
+    bool has_collisions() const;
+
+    /**
+     * @return `size_t` Overlapping pairs of cells separated last tick.
+     */
+    size_t get_overlaps() const;
+
+    /**
+     * @brief Turns cells feeding from the nutrient field on or off. Without
+     *        it cells only count down the life they started with.
+     */
+    void set_nutrients(bool enabled);
+    bool has_nutrients() const;
+    NutrientField & get_nutrients();
+
+    /**
+     * @brief Saves every cell, swarm cell, the world size and the random
+     *        engine to `path` (see `Snapshot.hpp`). Throws `LException` if
+     *        it can't be written.
+     *
+     * @return `size_t` The number of cells saved, swarm cells included.
+     */
+    size_t save_snapshot(const std::string & path) const;
+
+    /**
+     * @brief Replaces every entity with the cells saved in `path`, and
+     *        restores the world size, collisions and random engine. Throws
+     *        `LException` before anything is replaced if `path` is not a
+     *        complete snapshot.
+     */
+    void load_snapshot(const std::string & path);
+
+    void set_telemetry(TelemetryWriter * writer) override;
 
 private:
-    void game_objects_init();
+    void game_objects_init(const GameOptions & options);
+
+    // Retrieves the swarm, spawning it if it does not exist yet.
+    CellSwarm & get_swarm();
+
+    // Spawns an individual cell, counting it in `cell_count` and `cell_life`.
+    template <typename... Args>
+    Cell * spawn_cell(Args &&... args)
+    {
+        Cell * cell = spawn<Cell>(std::forward<Args>(args)...);
+        ++cell_count;
+        cell_life += cell->get_life();
+        return cell;
+    }
+
+    // Separates every overlapping pair of individual cells.
+    void resolve_overlaps();
+
+    // Counts every cell as eating from the nutrient field this tick.
+    void count_nutrient_demand();
+
+    // Steps the nutrient field one tick, taking out what the cells ate.
+    void step_nutrients();
+
+    // Pans the camera with the arrow keys held down.
+    void move_camera();
+
+    // Rebuilds `profile_lines` from the profiler's percentiles.
+    void update_profile_lines();
+    // Draws `profile_lines` in the top-right corner.
+    void draw_profile();
 
     void handle_event(SDL_Event & e) override;
     void update() override;
     void draw() override;
+    // Adds the swarm's births and deaths, the cell count and their mean life.
+    void fill_telemetry(TelemetryRecord & record) override;
+    // Hands entities the nutrient field while it is enabled, with the
+    // cells eating from it counted.
+    void fill_frame_context(FrameContext & context) override;
 };
 
 } // namespace LCode
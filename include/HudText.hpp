@@ -0,0 +1,108 @@
+/**
+ * @file    HudText.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   HudText class - A line of overlay text that only re-renders its
+ *          texture when the text actually changes, and can limit how often
+ *          the text is regenerated at all (e.g. FPS at 4 Hz).
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_HUDTEXT_HPP
+#define LCODE_HUDTEXT_HPP
+
+#include "LTexture.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstddef>
+
+namespace LCode
+{
+
+class HudText
+{
+    LTexture texture;
+    std::string text;
+    SDL_Color color;
+
+    // minimum time between text updates in ms (0 = every update)
+    double refresh_ms;
+    // time of the last text update in ms, negative before the first
+    double last_update_ms;
+    // true when `text` changed since the texture was last rendered
+    bool dirty;
+    // number of times the texture has been rendered from text
+    size_t reloads;
+
+public:
+    /**
+     * @param text_color Color to render the text in.
+     * @param refresh_interval_ms Minimum time between text updates in ms,
+     *                            0 lets the text change every frame.
+     */
+    HudText(SDL_Color text_color = SDL_Color{0x00, 0x00, 0x00, 0xFF},
+            double refresh_interval_ms = 0.0);
+
+    /**
+     * @brief Regenerates the text with `make_text()` if the refresh interval
+     *        has passed since the last update. Nothing is rendered until
+     *        `render()`, and only if the new text is different.
+     *
+     * @param now_ms    The current time in ms.
+     * @param make_text Callable returning the new text, anything convertible
+     *                  to `std::string_view` (e.g. a `TextBuffer`).
+     * @return true if the text changed.
+     */
+    template <typename TextFunction>
+    bool update(double now_ms, TextFunction && make_text)
+    {
+        if (!is_due(now_ms))
+        {
+            return false;
+        }
+        last_update_ms = now_ms;
+        return set_text(std::forward<TextFunction>(make_text)());
+    }
+
+    /**
+     * @return true if the refresh interval has passed since the last update.
+     */
+    bool is_due(double now_ms) const;
+
+    /**
+     * @brief Replaces the text, marking the texture dirty only if it changed.
+     *        The text is copied into storage that is reused between updates.
+     * @return true if the text changed.
+     */
+    bool set_text(std::string_view new_text);
+
+    void set_refresh_interval(double interval_ms);
+
+    /**
+     * @brief Re-renders the texture if the text is dirty, then draws it.
+     */
+    void render(float x, float y);
+
+    const std::string & get_text() const;
+    int get_width();
+    int get_height();
+
+    /**
+     * @return `size_t` How many times the texture was rendered from text.
+     */
+    size_t get_reload_count() const;
+};
+
+} // namespace LCode
+
+#endif // LCODE_HUDTEXT_HPP
@@ -2,30 +2,88 @@
 #ifndef LCODE_LENTITY_HPP
 #define LCODE_LENTITY_HPP
 
+#include "FrameContext.hpp"
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 
+#include <atomic>
+#include <cstdint>
+
 namespace LCode
 {
+
+class EntitySlab;
     
 class LEntity
 {
+    // SDLBaseGame flags and removes entities between frames
+    friend class SDLBaseGame;
+    // EntityPool records which slab an entity lives in
+    friend class EntityPool;
+    // CullGrid records which bucket an entity is in
+    friend class CullGrid;
+
+    // true once queued for removal, the entity is deallocated at the end of the frame
+    // (atomic since entities may delete themselves from update worker threads)
+    std::atomic<bool> deleted;
+    // the pool slab this entity was allocated from, nullptr if allocated with `new`
+    EntitySlab * slab;
+    // the CullGrid bucket holding this entity and its index in it, and
+    // when it was added to the game (entities are drawn in that order)
+    std::int32_t cull_bucket;
+    std::uint32_t cull_slot;
+    std::uint64_t draw_order;
+
 protected:
     // 2D Point using floats
     SDL_FPoint pos;
+    // `pos` before the latest simulation tick, drawn blended towards `pos`
+    SDL_FPoint prev_pos;
 
 public:
     LEntity();
     LEntity(SDL_FPoint new_pos);
     LEntity(float x, float y);
 
+    // entities are owned through pointers by SDLBaseGame, never copied
+    LEntity(const LEntity & other) = delete;
+    LEntity & operator = (const LEntity & other) = delete;
+
     virtual ~LEntity() = default;
-    virtual void update(double delta_ms) = 0;
+    // Simulates one tick, everything the game knows about it is in `context`.
+    virtual void update(const FrameContext & context) = 0;
     virtual void draw(GPU_Target * gpu) = 0;
+    // Drawn after every entity's batched shapes were submitted (e.g. text
+    // labels that must stay on top), does nothing by default.
+    virtual void draw_overlay(GPU_Target * gpu);
+    // Called before every fixed tick to remember the state the tick starts
+    // from, saves `pos` into `prev_pos` by default.
+    virtual void save_previous_state();
+    // Hash of everything that affects the simulation, compared between a
+    // recorded run and its replay. Hashes `pos` by default.
+    virtual std::uint64_t get_state_hash() const;
+    // The world area the entity draws inside of, for culling entities out
+    // of view. Must contain `pos`. An empty rectangle at `pos` by default.
+    virtual SDL_FRect get_bounds() const;
+    // True for entities that split their own update across the game's
+    // thread pool. They are updated on the main thread before the other
+    // entities are fanned out, since a nested `parallel_for` runs inline.
+    // False by default.
+    virtual bool splits_own_update() const;
+
+    bool is_deleted() const;
+
+    const SDL_FPoint & get_pos() const;
 
 protected:
+    // Queues this entity for removal, it stays valid until the end of the frame.
     void delete_self();
 
+    // `prev_pos` blended towards `pos` by the game's interpolation alpha,
+    // where the entity should be drawn this frame.
+    SDL_FPoint get_draw_pos() const;
+
 };
 
 } // namespace LCode
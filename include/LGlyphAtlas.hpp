@@ -0,0 +1,101 @@
+/**
+ * @file    LGlyphAtlas.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   LGlyphAtlas class - Every printable ASCII glyph of a font
+ *          rasterized once into a single `GPU_Image`. Strings are drawn as
+ *          one blit per glyph from that image, which SDL_gpu batches
+ *          together, instead of rendering a new surface and uploading a
+ *          new texture like `LTexture::load_text` does.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_LGLYPHATLAS_HPP
+#define LCODE_LGLYPHATLAS_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <array>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace LCode
+{
+
+class LGlyphAtlas
+{
+public:
+    // Range of characters rasterized into the atlas (printable ASCII).
+    static const char FIRST_GLYPH = ' ';
+    static const char LAST_GLYPH = '~';
+    static const int GLYPH_COUNT = LAST_GLYPH - FIRST_GLYPH + 1;
+
+private:
+    // One atlas per font, fonts are opened at a fixed size so this
+    // also keys on size.
+    static std::unordered_map<TTF_Font *, std::unique_ptr<LGlyphAtlas>> atlases;
+
+    // All glyphs, rendered white so they can be tinted with `GPU_SetColor`.
+    GPU_Image * image;
+    // Where each glyph is inside `image` (its width is the glyph advance).
+    std::array<GPU_Rect, GLYPH_COUNT> glyphs;
+    // Height of every glyph (the font line height).
+    int line_height;
+
+public:
+    /**
+     * @brief Rasterizes every glyph of `font` into the atlas image.
+     *        Prefer `get()`, which builds each font's atlas only once.
+     */
+    explicit LGlyphAtlas(TTF_Font * font);
+
+    LGlyphAtlas(const LGlyphAtlas & other) = delete;
+    LGlyphAtlas & operator = (const LGlyphAtlas & other) = delete;
+
+    ~LGlyphAtlas();
+
+    /**
+     * @brief Retrieves the atlas for `font`, building it on first use.
+     */
+    static LGlyphAtlas & get(TTF_Font * font);
+
+    /**
+     * @brief Frees every atlas built by `get()`. Call before the GPU
+     *        context and fonts are destroyed.
+     */
+    static void free_all();
+
+    /**
+     * @brief Draws `text` with its top-left corner at (x, y).
+     */
+    void draw(GPU_Target * gpu, std::string_view text, float x, float y, SDL_Color color);
+
+    /**
+     * @brief Draws `text` centered on (x, y).
+     */
+    void draw_centered(GPU_Target * gpu, std::string_view text, float x, float y,
+                       SDL_Color color);
+
+    /**
+     * @return `int` Width of `text` in pixels when drawn with this atlas.
+     */
+    int get_text_width(std::string_view text) const;
+
+    int get_line_height() const;
+
+private:
+    const GPU_Rect & get_glyph(char c) const;
+};
+
+} // namespace LCode
+
+#endif // LCODE_LGLYPHATLAS_HPP
@@ -5,6 +5,7 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 #include <SDL2/SDL_ttf.h>
+#include <memory>
 #include <string>
 
 namespace LCode
@@ -12,10 +13,12 @@ namespace LCode
 
 class LTexture
 {
-    // The texture
+    // The texture, shared with every LTexture of the same image or text
+    // through `TextureCache`, so color and blend mode are applied per render
     //SDL_Texture * texture;
-    GPU_Image * image;
+    std::shared_ptr<GPU_Image> image;
     SDL_Color color;
+    GPU_BlendPresetEnum blend_mode;
     int width, height;
     std::string file_path;
 
@@ -36,22 +39,28 @@ public:
     LTexture(GPU_Target * gpu_ref);
     LTexture(GPU_Target * gpu_ref, TTF_Font * font_ref);
 
-    // for memory safety
+    // copies share the image, nothing is loaded again
     LTexture(const LTexture & other);
     LTexture & operator = (const LTexture & other);
     void copy(const LTexture & other);
 
-    // deallocates memory
+    // moves take the image, leaving `other` empty
+    LTexture(LTexture && other) noexcept;
+    LTexture & operator = (LTexture && other) noexcept;
+
+    // releases this texture's share of the image
     ~LTexture();
 
 
     // sets the renderer used by all LTextures during loading (should be the window renderer)
     void set_gpu(GPU_Target * renderer_ref);
     static void set_fallback_gpu(GPU_Target * renderer_ref);
+    static GPU_Target * get_fallback_gpu();
 
     #ifdef SDL_TTF_MAJOR_VERSION
     void set_font(TTF_Font * font_ref);
     static void set_fallback_font(TTF_Font * font_ref);
+    static TTF_Font * get_fallback_font();
     #endif
 
     // loads image at specified path
@@ -62,7 +71,7 @@ public:
     bool load_text(std::string text, SDL_Color text_color = SDL_Color{0x00, 0x00, 0x00, 0xFF}, TTF_Font * font_override = nullptr);
     #endif
 
-    // deallocates texture
+    // releases the image, it is deallocated once no LTexture shares it
     void free();
 
     // set color modulation
@@ -71,7 +80,7 @@ public:
     void set_color(SDL_Color color);
     void set_alpha(Uint8 alpha);
 
-    void set_blend_mode(GPU_BlendPresetEnum blend_mode);
+    void set_blend_mode(GPU_BlendPresetEnum new_blend_mode);
 
     // Renders texture at specified point, and other optional parameters
     void render(float x, float y, GPU_Rect * clip = nullptr, float angle = 0.0,
@@ -0,0 +1,197 @@
+/**
+ * @file    NutrientField.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   NutrientField class - A grid of nutrient levels covering the
+ *          world that cells feed from to stay alive. Every tick the field
+ *          diffuses between neighboring grid cells, decays, grows back
+ *          towards its capacity, as a 5-point stencil pass. Rows are split
+ *          across threads and each row steps 4 (SSE) or 8 (AVX) grid cells
+ *          per instruction.
+ *
+ *          Cells are counted with `add_demand()` before they update, then
+ *          only read the field during their update (see
+ *          `FrameContext::nutrients`). What they ate is taken out of it by
+ *          the next `step()`, from the same counts.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_NUTRIENTFIELD_HPP
+#define LCODE_NUTRIENTFIELD_HPP
+
+#include "lilyutils.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+class ThreadPool;
+
+/**
+ * @brief How the field spreads, fades and feeds. Rates are per second.
+ */
+struct NutrientParams
+{
+    // World pixels covered by one grid cell along each axis.
+    float cell_size = 32.0f;
+    // Level of a full grid cell, the field starts full.
+    float capacity = 1.0f;
+    // Share of the difference to each neighbor that flows over.
+    float diffusion = 2.0f;
+    // Share of the level that is lost.
+    float decay = 0.05f;
+    // Share of the missing level (up to `capacity`) that grows back.
+    float regrowth = 0.25f;
+    // Share of a grid cell's level each cell inside it eats, until the
+    // cells inside would eat all of it and split it evenly instead.
+    float uptake = 0.5f;
+    // Seconds of life a cell gains per unit of nutrient eaten. At the
+    // defaults a cell needs a level of 0.5 to stop aging, which the field
+    // keeps up with at about 0.4 cells per grid cell.
+    float life_per_unit = 4.0f;
+};
+
+class NutrientField
+{
+public:
+    // Name of the SIMD kernel compiled in ("AVX", "SSE2" or "scalar").
+    static const char * const SIMD_NAME;
+    // Rows per chunk handed to an update thread.
+    static inline const size_t ROW_CHUNK = 16;
+
+private:
+    // values shared by every grid cell during one step
+    struct StepParams
+    {
+        // share flowing to each neighbor, and what a grid cell keeps
+        // of its own level
+        float spread = 0.0f;
+        float keep = 1.0f;
+        // level grown back this substep regardless of the current level
+        float growth = 0.0f;
+    };
+
+    NutrientParams params;
+    size_t columns, rows;
+    float inv_cell_size;
+    // last column and row as floats, for `grid_index()`
+    float max_column, max_row;
+    // row-major levels, and the levels being written by `step()`
+    std::vector<float> levels, next_levels;
+    // cells inside each grid cell, counted for the next `step()`
+    std::vector<float> demand;
+    // false forces the scalar kernel, to compare against the SIMD one
+    bool use_simd;
+
+public:
+    explicit NutrientField(const NutrientParams & field_params = NutrientParams{});
+    ~NutrientField();
+
+    /**
+     * @brief Covers a `world_width` by `world_height` world, refilling the
+     *        field to capacity if that changes the grid size.
+     */
+    void resize(int world_width, int world_height);
+
+    /**
+     * @brief Sets every grid cell to `level`.
+     */
+    void fill(float level);
+
+    /**
+     * @return `float` The level of the grid cell at world point (x, y),
+     *         points outside the world read the nearest edge.
+     */
+    float sample(float x, float y) const
+    {
+        return levels.empty()? 0.0f : levels[index_of(x, y)];
+    }
+
+    /**
+     * @return `float` The level a cell at world point (x, y) eats over
+     *         `delta_sec`, its share of what `step()` takes out of that grid
+     *         cell. Cells that weren't counted there eat nothing.
+     */
+    float feed(float x, float y, float delta_sec) const
+    {
+        if (demand.empty())
+        {
+            return 0.0f;
+        }
+        size_t index = index_of(x, y);
+        float cells = demand[index];
+        return cells > 0.0f? levels[index] * std::min(params.uptake * delta_sec, 1.0f / cells)
+                           : 0.0f;
+    }
+
+    /**
+     * @brief Forgets the cells counted for the last step.
+     */
+    void clear_demand();
+
+    /**
+     * @brief Counts one cell at world point (x, y) as eating this tick,
+     *        before it updates.
+     */
+    void add_demand(float x, float y)
+    {
+        if (!demand.empty())
+        {
+            demand[index_of(x, y)] += 1.0f;
+        }
+    }
+
+    /**
+     * @brief Takes out what the counted cells ate, then diffuses, decays
+     *        and regrows for `delta_ms`, in as many substeps as it takes for
+     *        no grid cell to give away more than its level. Rows are split
+     *        across `pool` if it isn't nullptr.
+     */
+    void step(double delta_ms, ThreadPool * pool = nullptr);
+
+    /**
+     * @return `double` The average level of every grid cell.
+     */
+    double get_mean_level() const;
+
+    size_t get_columns() const;
+    size_t get_rows() const;
+    const NutrientParams & get_params() const;
+
+    /**
+     * @brief Turns the SIMD stencil kernel on or off (off is for comparison).
+     */
+    void set_simd(bool enabled);
+    bool is_simd() const;
+
+private:
+    size_t index_of(float x, float y) const
+    {
+        // through int, which converts much faster than straight to size_t
+        int column = grid_index(x, inv_cell_size, max_column);
+        int row = grid_index(y, inv_cell_size, max_row);
+        return static_cast<size_t>(row) * columns + static_cast<size_t>(column);
+    }
+
+    // Steps rows [begin, end) from `levels` into `next_levels`.
+    void step_rows(size_t begin, size_t end, const StepParams & step_params);
+
+    // Steps columns [1, columns - 1) of one row with the SIMD kernel,
+    // returns the first column left for the scalar loop.
+    size_t step_row_simd(const float * above, const float * row, const float * below,
+                         float * out, const StepParams & step_params) const;
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_NUTRIENTFIELD_HPP
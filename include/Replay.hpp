@@ -0,0 +1,174 @@
+/**
+ * @file    Replay.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   ReplayWriter and ReplayReader classes - A compact binary log of
+ *          everything a run depends on: the random seed and startup
+ *          options, then every frame's input events and wall-clock time.
+ *          Feeding it back through `SDLBaseGame::run_replay()` reproduces
+ *          the run tick for tick, checked by a state checksum at the end.
+ *
+ *          Layout (little-endian, as written by the host): a `ReplayHeader`,
+ *          then records of one `ReplayRecord::Type` byte followed by its
+ *          fields, ending with an `END` record.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_REPLAY_HPP
+#define LCODE_REPLAY_HPP
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+/**
+ * @brief Everything needed to start a run in the same state it was recorded in.
+ */
+struct ReplayHeader
+{
+    // Seed passed to `set_rand_seed()` before any entity was created.
+    std::uint64_t seed = 0;
+    // Fixed simulation tick rate and the most ticks per frame.
+    double tick_rate = 0.0;
+    std::int32_t max_ticks_per_frame = 0;
+    // Size of the screen entities were simulated inside.
+    std::int32_t screen_width = 0,
+                 screen_height = 0;
+    // Startup entities of the recorded game.
+    std::uint64_t cells = 0,
+                  swarm_cells = 0;
+    // Whether the game started paused.
+    std::uint8_t start_paused = 0;
+    // Whether cells started out colliding.
+    std::uint8_t collisions = 0;
+    // Whether cells started out feeding from the nutrient field.
+    std::uint8_t nutrients = 0;
+    // Whether the swarm and nutrient field ran their scalar kernels
+    // (`--scalar`), which round differently from the SIMD ones.
+    std::uint8_t scalar = 0;
+    // Size of the world if it was set apart from the screen, 0 otherwise.
+    std::int32_t world_width = 0,
+                 world_height = 0;
+    // `SDLBaseGame::get_state_checksum()` once the game was created.
+    std::uint64_t start_checksum = 0;
+};
+
+/**
+ * @brief One entry of the log, read back by `ReplayReader::next()`.
+ */
+struct ReplayRecord
+{
+    enum class Type : std::uint8_t
+    {
+        // A key was pressed or released
+        KEY,
+        // The screen was resized
+        RESIZE,
+        // A frame ended after `frame_ms` of wall-clock time
+        FRAME,
+        // The run ended, with its frame count and checksum
+        END
+    };
+
+    Type type = Type::END;
+    // KEY
+    std::uint16_t scancode = 0;
+    std::uint8_t key_down = 0,
+                 repeat = 0;
+    // RESIZE
+    std::int32_t width = 0,
+                 height = 0;
+    // FRAME
+    double frame_ms = 0.0;
+    // END
+    std::uint64_t frames = 0,
+                  checksum = 0;
+};
+
+/**
+ * @brief Outcome of `SDLBaseGame::run_replay()`.
+ */
+struct ReplayResult
+{
+    // Frames replayed, and the frame count the recording ended with.
+    std::uint64_t frames = 0,
+                  expected_frames = 0;
+    // State checksum after replaying, and the one the recording ended with.
+    std::uint64_t checksum = 0,
+                  expected_checksum = 0;
+    // false if the recording was cut off before its `END` record.
+    bool complete = false;
+
+    bool matches() const
+    {
+        return complete && frames == expected_frames && checksum == expected_checksum;
+    }
+};
+
+std::ostream & operator << (std::ostream & os, const ReplayResult & result);
+
+
+class ReplayWriter
+{
+    std::ofstream file;
+    bool finished;
+
+public:
+    /**
+     * @brief Creates the file at `path` and writes the header.
+     *        Throws `LException` if it can't be written.
+     */
+    ReplayWriter(const std::string & path, const ReplayHeader & header);
+
+    ReplayWriter(const ReplayWriter & other) = delete;
+    ReplayWriter & operator = (const ReplayWriter & other) = delete;
+
+    void write_key(std::uint16_t scancode, bool key_down, bool repeat);
+    void write_resize(std::int32_t width, std::int32_t height);
+    void write_frame(double frame_ms);
+
+    /**
+     * @brief Writes the `END` record, nothing can be written after it.
+     */
+    void finish(std::uint64_t frames, std::uint64_t checksum);
+
+    bool is_finished() const;
+};
+
+
+class ReplayReader
+{
+    std::ifstream file;
+    ReplayHeader header;
+
+public:
+    /**
+     * @brief Opens the file at `path` and reads the header.
+     *        Throws `LException` if it is missing or not a replay.
+     */
+    explicit ReplayReader(const std::string & path);
+
+    const ReplayHeader & get_header() const;
+
+    /**
+     * @brief Reads the next record into `record`.
+     * @return false at the end of the file. Throws `LException`
+     *         if the file ends in the middle of a record.
+     */
+    bool next(ReplayRecord & record);
+};
+
+} // namespace LCode
+
+#endif // LCODE_REPLAY_HPP
@@ -6,6 +6,8 @@
  *          generic SDL2 Game. Simply define a subclass that inherits from
  *          SDLBaseGame and override the functions handle_events, update,
  *          and draw, then let SDLBaseGame handle the logic!
+ *          Entities live in a world that can be larger than the window,
+ *          and only the ones in view of the camera are drawn.
  * 
  * @version 0.1
  * @date    2023-11-25
@@ -19,18 +21,49 @@
 #define LCODE_SDLBASEGAME_HPP
 
 #include "LTimer.hpp"
+#include "FramePacer.hpp"
+#include "FrameProfiler.hpp"
 #include "LEntity.hpp"
+#include "FrameContext.hpp"
+#include "EntityPool.hpp"
+#include "ThreadPool.hpp"
+#include "ShapeBatch.hpp"
+#include "headless.hpp"
+#include "Replay.hpp"
+#include "Telemetry.hpp"
+#include "AssetLoader.hpp"
+#include "Camera.hpp"
+#include "CullGrid.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 #include <SDL2/SDL_ttf.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
+#include <utility>
 #include <cstddef>
 
 namespace LCode
 {
 
+/**
+ * @brief One step of startup and how long it took (see
+ *        `SDLBaseGame::get_load_stages()`).
+ */
+struct LoadStage
+{
+    std::string name{};
+    double ms = 0.0;
+    // true if it ran on a background thread, alongside the other stages
+    bool background = false;
+};
+
 class SDLBaseGame
 {
 /******************************************************************************
@@ -44,6 +77,20 @@ private:
     // Pointer to the current instance (only one should be running at any time)
     static inline SDLBaseGame * current_instance = nullptr;
 
+public:
+    // Simulation ticks per second `run()` updates at unless changed.
+    static inline const double DEFAULT_TICK_RATE = 60.0;
+    // Most ticks `run()` simulates per frame before dropping the backlog.
+    static inline const int DEFAULT_MAX_TICKS_PER_FRAME = 5;
+    // Side of the buckets entities are culled with, entities with bounds
+    // larger than this are tested against the view one by one instead.
+    static inline const float CULL_CELL_SIZE = 256.0f;
+    // World units entities are still drawn past the edge of the view, to
+    // cover how far they move between the last tick and the drawn frame.
+    static inline const float CULL_MARGIN = 32.0f;
+    // Font text is drawn with unless a texture is given another one.
+    static inline const char * const FONT_PATH = "assets/Sol Schori.ttf";
+
 /******************************************************************************
  *                          STATIC CLASS METHODS                              *
  ******************************************************************************/
@@ -78,6 +125,15 @@ public:
      */
     static float get_random_screen_y();
 
+    /**
+     * @brief Retrieves a random floating-point position within the world,
+     *        which is the screen area unless `set_world_size()` was called.
+     *
+     * @return a random `SDL_FPoint` in the bounds of
+     *         ([0, world_rect.w], [0, world_rect.h])
+     */
+    static SDL_FPoint get_random_world_point();
+
     /**
      * @brief Flags the current instance to stop the run loop.
      */
@@ -88,8 +144,89 @@ public:
  *                           INSTANCE VARIABLES                               *
  ******************************************************************************/
 private:
+    // slab allocator that entities created with `spawn()` live in
+    EntityPool entity_pool;
     // list of active game entities
     std::vector<LEntity *> entities;
+    // number of entities in `entities` flagged for removal at the end of this frame
+    std::atomic<size_t> pending_removals;
+    // number of entities removed at the end of the last frame
+    size_t removed_last_frame;
+
+    // worker threads for `update_entities()`, nullptr when updating serially
+    std::unique_ptr<ThreadPool> update_pool;
+    // true while entities are being updated by more than one thread
+    bool updating_in_parallel;
+    // entities added during a parallel update, merged into `entities` after it
+    std::vector<LEntity *> pending_spawns;
+    // guards `pending_spawns` and `entity_pool` during a parallel update
+    std::mutex spawn_mutex;
+
+    // -------- fixed timestep --------
+    // simulated milliseconds per update tick in `run()`
+    double tick_ms;
+    // most ticks run in one frame, the rest of the backlog is dropped
+    int max_ticks_per_frame;
+    // wall-clock time not simulated yet, under one tick after each frame
+    double tick_accumulator;
+    // how far the drawn frame is between the last two ticks, [0, 1]
+    double interpolation_alpha;
+    // number of ticks simulated during the last frame
+    int ticks_last_frame;
+
+    // -------- frame pacing --------
+    // holds `run()` to the target frame time after every flip
+    FramePacer frame_pacer;
+    // true when `GPU_Flip` waits for the display refresh
+    bool vsync;
+    // times every phase of the recent frames
+    FrameProfiler profiler;
+
+    // -------- input and recording --------
+    // which keys are held, tracked from key events so replays see the same state
+    std::array<bool, SDL_NUM_SCANCODES> keys_down;
+    // the key each `InputAction` is mapped to
+    std::array<SDL_Scancode, static_cast<size_t>(InputAction::COUNT)> action_keys;
+    // what every entity sees of the current tick, rebuilt by `update_entities()`
+    FrameContext frame_context;
+    // what entities changed since the last `take_update_tally()`
+    UpdateTally update_tally;
+    // logs every frame of `run()` when set, not owned
+    ReplayWriter * recorder;
+    // gets one record per frame of `run()` and `run_headless()` when set, not owned
+    TelemetryWriter * telemetry;
+    // entities removed since the game started, and the entity count and
+    // removals at the last telemetry record, to count births and deaths
+    std::uint64_t removed_total;
+    size_t telemetry_entities;
+    std::uint64_t telemetry_removed;
+
+    // -------- world and view --------
+    // the area entities live in, starting at (0, 0)
+    SDL_Rect world_rect;
+    // true while the world is resized along with the window
+    bool world_follows_window;
+    // the part of the world `draw_entities()` draws
+    Camera camera;
+    // false draws every entity, to compare against culling
+    bool culling;
+    // entities bucketed by position, an entity only changes bucket when
+    // an update moves it into another one
+    CullGrid cull_grid;
+    // entities the update threads saw change bucket, moved once they're done
+    std::vector<LEntity *> cull_moves;
+    // guards `cull_moves` and `update_tally` during a parallel update
+    std::mutex update_merge_mutex;
+    // the entities drawn this frame, in `entities` order
+    std::vector<LEntity *> visible_entities;
+
+    // -------- startup --------
+    // opens the font while the window is created, and initializes
+    // SDL_ttf and SDL_image on first use
+    AssetLoader assets;
+    // every stage of startup marked so far, and when the last one ended
+    std::vector<LoadStage> load_stages;
+    double load_stage_end_ms;
 
 protected:
     // -------- SDL dynamically allocated objects --------
@@ -99,6 +236,8 @@ protected:
     GPU_Target * gpu;
     // The default font to use as a fallback in `LTexture` text rendering.
     TTF_Font * font;
+    // Shapes added by entities during `draw_entities()`, submitted together.
+    ShapeBatch shape_batch;
 
     // -------- Game objects --------
     // Times how long the initialization loading takes.
@@ -113,9 +252,13 @@ protected:
     int frames;
     // This flag controls the main run loop, set to false to exit.
     bool running;
-    // The time of the last frame since initialization, used to calculate delta.
+    // true when running without a window, GPU context or font.
+    bool headless;
+    // The time of the last frame since initialization, used to calculate frame_ms.
     double last_frame_time;
-    // The time since the last frame.
+    // The wall-clock time since the last frame.
+    double frame_ms;
+    // The time simulated by the current update, one tick in `run()`.
     double delta;
     // The average FPS since initialization.
     double avg_fps;
@@ -133,8 +276,12 @@ public:
      * @param screen_width  The desired screen width for the window.
      * @param screen_height The desired screen height for the window.
      * @param font_size     The desired font size for the default font.
+     * @param headless      When true, skip all video, GPU and font setup and
+     *                      only simulate inside a virtual screen of the given
+     *                      size. Use `run_headless()` instead of `run()`.
      */
-    SDLBaseGame(int screen_width = 640, int screen_height = 480, int font_size = 16);
+    SDLBaseGame(int screen_width = 640, int screen_height = 480, int font_size = 16,
+                bool headless = false);
 
     // Don't allow copying
     SDLBaseGame(const SDLBaseGame & other) = delete;
@@ -155,12 +302,78 @@ public:
     /**
      * @brief The main run loop! This will handle events, updating, and drawing
      *        every frame in the base system and the subclass virtual methods
-     *        until `running` is false.
+     *        until `running` is false. `update()` runs at the fixed tick rate
+     *        (see `set_tick_rate()`), as many times per frame as the elapsed
+     *        time needs, and entities are drawn interpolated between ticks.
      * 
      * @return `int` Program return code, return this in `main()`.
      */
     virtual int run();
 
+    /**
+     * @brief The headless run loop. Calls the subclass `update()` (and so
+     *        `update_entities()`) without polling events or drawing, until
+     *        one of the stop conditions in `config` is reached or `running`
+     *        is set to false.
+     *
+     * @param config Frame/time limits and the delta to simulate with.
+     * @return `HeadlessReport` with step throughput and entity counts.
+     */
+    HeadlessReport run_headless(const HeadlessConfig & config);
+
+    /**
+     * @brief Replays a run logged by a `ReplayWriter`: feeds the recorded
+     *        key events, screen sizes and frame times through the same
+     *        fixed-timestep updates as `run()`, drawing too unless
+     *        headless. The game must be created from the replay's header.
+     *
+     * @return `ReplayResult` with the expected and reproduced checksums.
+     */
+    ReplayResult run_replay(ReplayReader & reader);
+
+    /**
+     * @brief Logs every frame of `run()` to `writer` until it returns,
+     *        starting with the current screen size. nullptr stops recording.
+     *        `run()` finishes the log with the final checksum.
+     */
+    void set_recorder(ReplayWriter * writer);
+
+    /**
+     * @brief Pushes a `TelemetryRecord` to `writer` at the end of every frame
+     *        of `run()` and `run_headless()`. nullptr stops. Births and
+     *        deaths are counted from this call on.
+     */
+    virtual void set_telemetry(TelemetryWriter * writer);
+
+    /**
+     * @return `std::uint64_t` Hash of the entity count and every entity's
+     *         `get_state_hash()`, in order.
+     */
+    std::uint64_t get_state_checksum() const;
+
+    /**
+     * @return true if `key` is held down. Use instead of
+     *         `SDL_GetKeyboardState` so recorded runs replay the same input.
+     */
+    bool is_key_down(SDL_Scancode key) const;
+
+    /**
+     * @brief Maps `action` to `key`, from the next tick on.
+     */
+    void set_action_key(InputAction action, SDL_Scancode key);
+    SDL_Scancode get_action_key(InputAction action) const;
+
+    /**
+     * @return `const FrameContext &` The context the last (or current)
+     *         `update_entities()` passed to every entity.
+     */
+    const FrameContext & get_frame_context() const;
+
+    /**
+     * @return true if this game was constructed without a window or GPU.
+     */
+    bool is_headless() const;
+
     /**
      * @brief Sets `running` to false to exit the main game `run()` loop.
      */
@@ -172,11 +385,48 @@ public:
      */
     const SDL_Rect & get_window_rect();
 
+    /**
+     * @brief Makes the world entities live in `width` by `height`, separate
+     *        from the window. 0 (or less) resizes it along with the window
+     *        again. The camera is centered on the world.
+     */
+    void set_world_size(int width, int height);
+
+    /**
+     * @return `const SDL_Rect &` The area entities live in, the same as
+     *         the window size unless `set_world_size()` was called.
+     */
+    const SDL_Rect & get_world_rect() const;
+
+    /**
+     * @return true if the world is resized along with the window.
+     */
+    bool is_world_following_window() const;
+
+    /**
+     * @return `Camera &` The view of the world `draw_entities()` draws.
+     */
+    Camera & get_camera();
+
+    /**
+     * @brief Turns drawing only the entities in view on or off.
+     */
+    void set_culling(bool enabled);
+    bool is_culling() const;
+
+    /**
+     * @return `size_t` The number of entities drawn by the last
+     *         `draw_entities()`.
+     */
+    size_t get_drawn_last_frame() const;
+
     /**
      * @brief Add a pointer to a newly allocated `LEntity` object,
      *        transferring ownership of the pointer to `SDLBaseGame`
      *        which will eventually deallocate them when `delete_entity`
      *        is called or during the destructor/`free()`.
+     *        Entities added during a parallel `update_entities()` are
+     *        queued and join `entities` once every worker is done.
      * 
      * @param new_entity Pointer to a newly allocated `LEntity` object.
      * @return `LEntity *` The pointer passed in. 
@@ -184,23 +434,154 @@ public:
     LEntity * add_entity(LEntity * new_entity);
 
     /**
-     * @brief Searches the `entities` vector for elements that match the
-     *        given pointer, then deallocates and removes them from the vector.
+     * @brief Constructs a new `EntityT` inside the entity pool and adds it
+     *        to `entities`. Prefer this over `add_entity(new EntityT)` for
+     *        entities that are created and destroyed often, since pooled
+     *        entities are stored contiguously and their memory is recycled.
+     * 
+     * @param args Arguments forwarded to the `EntityT` constructor.
+     * @return `EntityT *` The new entity, still owned by `SDLBaseGame`.
+     */
+    template <typename EntityT, typename... Args>
+    EntityT * spawn(Args &&... args)
+    {
+        if (updating_in_parallel)
+        {
+            std::lock_guard<std::mutex> lock{spawn_mutex};
+            EntityT * new_entity = entity_pool.create<EntityT>(std::forward<Args>(args)...);
+            pending_spawns.push_back(new_entity);
+            return new_entity;
+        }
+        EntityT * new_entity = entity_pool.create<EntityT>(std::forward<Args>(args)...);
+        add_entity(new_entity);
+        return new_entity;
+    }
+
+    /**
+     * @brief Flags the given entity for removal. It is deallocated and
+     *        removed from the `entities` vector at the end of the frame
+     *        by `remove_deleted_entities()`, so it is safe to call
+     *        during `update_entities()` (see `LEntity::delete_self()`).
+     *        Entities that weren't added to this game are left alone.
      * 
      * @param entity_to_remove The `LEntity` pointer to delete and remove.
-     * @return `LEntity *` The pointer passed in.
+     * @return `LEntity *` The pointer passed in. 
      */
     LEntity * delete_entity(LEntity * entity_to_remove);
 
     /**
-     * @brief Deallocates the `LEntity` at the given index and then removes
-     *        its pointer from the `entities` vector.
+     * @brief Flags the `LEntity` at the given index for removal at the
+     *        end of the frame.
      * 
      * @param index The index to remove from `entities`.
-     * @return `LEntity *` The pointer removed from that index. 
+     * @return `LEntity *` The pointer flagged at that index. 
      */
     LEntity * delete_entity(size_t index);
 
+    /**
+     * @return `size_t` The number of entities removed at the end of the last frame.
+     */
+    size_t get_removed_last_frame() const;
+
+    /**
+     * @return `const EntityPool &` The pool used by `spawn()`, for its stats.
+     */
+    const EntityPool & get_entity_pool() const;
+
+    /**
+     * @brief Sets how many threads `update_entities()` splits the entities
+     *        between. 1 updates serially on the main thread, 0 uses every
+     *        hardware thread.
+     */
+    void set_update_threads(size_t thread_count);
+
+    /**
+     * @return `size_t` The number of threads entities are updated with.
+     */
+    size_t get_update_threads() const;
+
+    /**
+     * @return `ThreadPool *` The update worker pool, for entities that want
+     *         to split their own work (nullptr when updating serially).
+     */
+    ThreadPool * get_thread_pool();
+
+    /**
+     * @return `ShapeBatch &` The batch entities add their shapes to while
+     *         drawing, submitted once all entities have drawn.
+     */
+    ShapeBatch & get_shape_batch();
+
+    /**
+     * @brief Sets how many fixed simulation ticks per second `run()` updates
+     *        at, independent of the frame rate.
+     */
+    void set_tick_rate(double ticks_per_second);
+
+    /**
+     * @return `double` The simulation ticks per second of `run()`.
+     */
+    double get_tick_rate() const;
+
+    /**
+     * @brief Sets the most ticks `run()` simulates in one frame. When the
+     *        game falls further behind (a stall, or updates slower than the
+     *        tick rate) the extra time is dropped and the simulation slows
+     *        down instead of every frame taking longer than the last.
+     */
+    void set_max_ticks_per_frame(int max_ticks);
+
+    /**
+     * @return `int` The number of ticks simulated during the last frame.
+     */
+    int get_ticks_last_frame() const;
+
+    /**
+     * @return `FrameProfiler &` The per-phase timings of the recent frames
+     *         of `run()` or `run_headless()`.
+     */
+    FrameProfiler & get_profiler();
+
+    /**
+     * @return `const std::vector<LoadStage> &` Every stage of startup in
+     *         the order they finished, including ones marked by the
+     *         subclass with `mark_load_stage()`.
+     */
+    const std::vector<LoadStage> & get_load_stages() const;
+
+    /**
+     * @return `std::string` The load stages on one line, e.g.
+     *         "SDL init 12 ms, window + GPU 85 ms, ...".
+     */
+    std::string get_load_breakdown() const;
+
+    /**
+     * @return `AssetLoader &` Loads fonts and images, on background
+     *         threads if asked to.
+     */
+    AssetLoader & get_assets();
+
+    /**
+     * @return `FramePacer &` The pacer `run()` waits on after every frame,
+     *         to set its target frame rate or read its jitter stats.
+     */
+    FramePacer & get_frame_pacer();
+
+    /**
+     * @brief Turns waiting for the display refresh in `GPU_Flip` on or off.
+     *        Can be combined with the frame pacer, does nothing headless.
+     */
+    void set_vsync(bool enabled);
+
+    bool is_vsync() const;
+
+    /**
+     * @return `double` How far the current frame is between the previous
+     *         and the latest tick, from 0 to 1. Entities draw their
+     *         positions blended by this (see `LEntity::get_draw_pos()`).
+     */
+    double get_interpolation_alpha() const;
+
 
 /******************************************************************************
  *                       PROTECTED INSTANCE METHODS                           *
@@ -226,34 +607,103 @@ protected:
      */
     virtual void draw() = 0;
 
+    /**
+     * @brief Records the time since the last stage ended (or since the game
+     *        was created) as the load stage `name`. The subclass marks its
+     *        own stages this way before pausing `load_timer`.
+     */
+    void mark_load_stage(const std::string & name);
+
+    /**
+     * @brief Adds game-specific stats (cells, mean life) to the record of
+     *        the frame that just ended, before it is pushed. Entity counts
+     *        and times are already filled in. Does nothing by default.
+     */
+    virtual void fill_telemetry(TelemetryRecord & record);
+
+    /**
+     * @brief Adds game-specific state (e.g. the nutrient field) to the
+     *        context every entity is updated with this tick. The delta,
+     *        world and input are already filled in. Does nothing by default.
+     */
+    virtual void fill_frame_context(FrameContext & context);
+
 
     // -------- ENTITY CONTROL METHODS --------
 
     const std::vector<LEntity *> & get_entities() const;
 
     /**
-     * @brief Calls `update()` on every `LEntity` within the `entities` vector.
+     * @brief Builds this tick's `FrameContext` from `delta`, the world and
+     *        the held keys, then calls `update()` with it on every `LEntity`
+     *        within the `entities` vector, in chunks across the update
+     *        threads when there are enough entities (see `set_update_threads()`).
+     *        Entities that split their own update across the threads are
+     *        updated first, outside the fan-out, so they keep every thread.
      */
     void update_entities();
 
     /**
-     * @brief Calls `draw()` on every `LEntity` within the `entities` vector.
+     * @brief Call after moving `entity` outside of its `update()`, so it is
+     *        culled where it is now instead of where its update left it.
+     */
+    void entity_moved(LEntity * entity);
+
+    /**
+     * @return `UpdateTally` What entities changed in their updates since
+     *         the last call, starting a new tally.
+     */
+    UpdateTally take_update_tally();
+
+    /**
+     * @brief Calls `draw()` on every `LEntity` in view of the camera,
+     *        submits the shapes they batched, then calls `draw_overlay()`
+     *        on them so overlays land on top of the shapes. Everything is
+     *        drawn in world coordinates through the camera, which is reset
+     *        to screen coordinates afterwards.
      */
     void draw_entities();
 
+    /**
+     * @brief Calls `save_previous_state()` on every `LEntity` so the coming
+     *        tick can be interpolated from where they are now.
+     */
+    void save_previous_states();
+
+    /**
+     * @brief Deallocates every entity flagged by `delete_entity()` and
+     *        compacts the `entities` vector in a single stable pass.
+     *        Called once per frame by the run loops after `update()`.
+     */
+    void remove_deleted_entities();
+
 /******************************************************************************
  *          PRIVATE INSTANCE METHODS (Internal implementation use)            *
  ******************************************************************************/
 private:
     void SDL_systems_init();
     void SDL_objects_init(int screen_width = 640, int screen_height = 480, int font_size = 16);
+    void headless_init(int screen_width, int screen_height);
 
     void system_handle_event(SDL_Event & e);
+    // Runs as many fixed ticks as `frame_ms` added up to.
+    void run_ticks();
+    // Pushes the record of the frame that just ended, `sim_ms` long.
+    void push_telemetry(double sim_ms);
     void system_update();
     void system_draw_begin();
     void system_draw_end();
 
     void update_window_rect();
+    // Matches the world (if it follows the window) and camera to `window_rect`.
+    void update_world_rect();
+
+    // Fills `visible_entities` with the entities in view, in order.
+    void find_visible_entities();
+
+    void merge_pending_spawns();
+    // Whether `entity` is in `entities` or waiting in `pending_spawns`.
+    bool holds_entity(LEntity * entity);
 
     void quit_SDL_systems();
     void free_SDL_objects();
@@ -0,0 +1,131 @@
+/**
+ * @file    ShapeBatch.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   ShapeBatch class - Collects filled circles, rings and rectangles
+ *          as triangles in one vertex buffer over a frame, then submits
+ *          them with as few `GPU_TriangleBatch` calls as the 16-bit index
+ *          limit allows, instead of one SDL_gpu call per shape.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_SHAPEBATCH_HPP
+#define LCODE_SHAPEBATCH_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <array>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+class ShapeBatch
+{
+public:
+    // Fewest and most segments a circle is tessellated into.
+    static constexpr int MIN_SEGMENTS = 12;
+    static constexpr int MAX_SEGMENTS = 64;
+
+private:
+    // floats per vertex for GPU_BATCH_XY_RGBA: x, y, r, g, b, a
+    static constexpr size_t FLOATS_PER_VERTEX = 6;
+    // GPU_TriangleBatch takes 16-bit vertex counts and indices
+    static constexpr size_t MAX_CHUNK_VERTICES = 0xFFFF;
+
+    // Vertices and indices for one GPU_TriangleBatch call.
+    struct Chunk
+    {
+        std::vector<float> vertices{};
+        std::vector<unsigned short> indices{};
+    };
+
+    // Unit circle points for each segment count, built on first use.
+    struct UnitCircle
+    {
+        std::vector<float> cos{}, sin{};
+    };
+
+    // chunks are kept between frames to reuse their memory,
+    // only the first `active_chunks` hold this frame's shapes
+    std::vector<Chunk> chunks;
+    size_t active_chunks;
+    std::array<UnitCircle, MAX_SEGMENTS + 1> unit_circles;
+    // screen pixels per unit the shapes are drawn at
+    float scale;
+
+    // -------- counters from the last flush --------
+    size_t draw_calls;
+    size_t vertex_count;
+    size_t triangle_count;
+
+public:
+    ShapeBatch();
+
+    /**
+     * @brief Adds a filled circle centered on (x, y).
+     */
+    void add_filled_circle(float x, float y, float radius, SDL_Color color);
+
+    /**
+     * @brief Adds a ring (annulus) centered on (x, y) covering the area
+     *        between `inner_radius` and `outer_radius`.
+     */
+    void add_ring(float x, float y, float inner_radius, float outer_radius, SDL_Color color);
+
+    /**
+     * @brief Adds a filled axis-aligned rectangle from (x1, y1) to (x2, y2).
+     */
+    void add_rectangle(float x1, float y1, float x2, float y2, SDL_Color color);
+
+    /**
+     * @brief Submits every shape added since the last flush to `gpu` and
+     *        empties the batch.
+     */
+    void flush(GPU_Target * gpu);
+
+    /**
+     * @brief Discards every shape added since the last flush.
+     */
+    void clear();
+
+    /**
+     * @brief Sets how many screen pixels one unit of the shapes covers (the
+     *        camera zoom), so circles get as many segments as their size
+     *        on screen needs.
+     */
+    void set_scale(float pixels_per_unit);
+    float get_scale() const;
+
+    /**
+     * @return `int` How many segments a circle of `radius` is built from.
+     */
+    static int get_segments(float radius);
+
+    // Counters from the last `flush()`
+    size_t get_draw_calls() const;
+    size_t get_vertex_count() const;
+    size_t get_triangle_count() const;
+
+private:
+    /**
+     * @brief Returns a chunk with room for `vertices` more vertices.
+     */
+    Chunk & reserve(size_t vertices);
+
+    const UnitCircle & get_unit_circle(int segments);
+
+    static void push_vertex(Chunk & chunk, float x, float y, const float rgba[4]);
+};
+
+} // namespace LCode
+
+#endif // LCODE_SHAPEBATCH_HPP
@@ -0,0 +1,172 @@
+/**
+ * @file    Snapshot.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   SnapshotWriter and SnapshotReader classes - A packed binary copy
+ *          of the whole population: every `Cell`, every swarm cell and the
+ *          random engine state, so a run can be saved and picked up again.
+ *
+ *          Layout (in the host's byte order, rejected on a host of the other
+ *          one): a `SnapshotHeader`, then `cells` `CellRecord`s, then the
+ *          swarm as one array per property (x, y, velocity x, velocity y,
+ *          speed, radius, life, total life, color), each `swarm_cells`
+ *          values long. Every section is at a fixed offset and stored
+ *          exactly as it is in memory, so loading is one bulk read per
+ *          array with no per-field parsing, and the file could just as well
+ *          be memory-mapped.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_SNAPSHOT_HPP
+#define LCODE_SNAPSHOT_HPP
+
+#include <SDL2/SDL.h>
+
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+/**
+ * @brief The start of every snapshot file, read and written in one piece.
+ */
+struct SnapshotHeader
+{
+    char magic[4] = {'L', 'S', 'N', 'P'};
+    std::uint32_t version = 0;
+    // `BYTE_ORDER_MARK` as written by the saving host
+    std::uint32_t byte_order = 0;
+    // Size of the world, 0 if it followed the window.
+    std::int32_t world_width = 0,
+                 world_height = 0;
+    // Whether cells were colliding.
+    std::uint8_t collisions = 0;
+    // Whether cells fed from the nutrient field, the field itself isn't
+    // saved and starts out full again.
+    std::uint8_t nutrients = 0;
+    std::uint8_t reserved[2] = {};
+    // Seed last given to `set_rand_seed()` and the saving thread's engine
+    // state, so random numbers continue where they left off.
+    std::uint64_t seed = 0;
+    std::uint64_t rand_state[4] = {};
+    // Number of `CellRecord`s and of swarm cells that follow.
+    std::uint64_t cells = 0,
+                  swarm_cells = 0;
+};
+
+/**
+ * @brief One individual `Cell`, stored as-is in the file.
+ */
+struct CellRecord
+{
+    float x = 0.0f,
+          y = 0.0f;
+    float velocity_x = 0.0f,
+          velocity_y = 0.0f;
+    double life = 0.0,
+           life_total = 0.0;
+    float speed = 0.0f;
+    Sint16 radius = 0;
+    Uint8 width = 0;
+    Uint8 draw_box = 0;
+    SDL_Color color{0, 0, 0, 0};
+    std::uint32_t reserved = 0;
+};
+
+// the layouts are the file format, padding must not sneak in
+static_assert(sizeof(SnapshotHeader) == 80, "SnapshotHeader layout changed");
+static_assert(sizeof(CellRecord) == 48, "CellRecord layout changed");
+static_assert(std::is_trivially_copyable_v<CellRecord>, "CellRecord must be bulk-copyable");
+
+
+class SnapshotWriter
+{
+    std::ofstream file;
+    std::string path;
+
+public:
+    /**
+     * @brief Creates the file at `path` and writes `header`, filling in its
+     *        version and byte order. Throws `LException` if it can't be written.
+     */
+    SnapshotWriter(const std::string & file_path, SnapshotHeader header);
+
+    SnapshotWriter(const SnapshotWriter & other) = delete;
+    SnapshotWriter & operator = (const SnapshotWriter & other) = delete;
+
+    /**
+     * @brief Writes `count` values from `values` as one block.
+     */
+    template <typename T>
+    void write_array(const T * values, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only plain values can be written");
+        write_bytes(values, count * sizeof(T));
+    }
+
+    /**
+     * @brief Flushes the file, throws `LException` if any write failed.
+     */
+    void finish();
+
+private:
+    void write_bytes(const void * bytes, size_t size);
+};
+
+
+class SnapshotReader
+{
+    std::ifstream file;
+    std::string path;
+    SnapshotHeader header;
+
+public:
+    // Version written into and expected from snapshot files.
+    static const std::uint32_t VERSION = 1;
+    static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    // Bytes stored per swarm cell: position, velocity, speed, radius, life
+    // and total life as floats, then the color.
+    static const size_t SWARM_CELL_BYTES = 8 * sizeof(float) + sizeof(SDL_Color);
+
+    /**
+     * @brief Opens the file at `file_path` and reads the header. Throws
+     *        `LException` if it is missing, not a snapshot, or shorter
+     *        than the header says.
+     */
+    explicit SnapshotReader(const std::string & file_path);
+
+    const SnapshotHeader & get_header() const;
+
+    /**
+     * @brief Reads the next `count` values into `out` as one block.
+     *        Throws `LException` if the file ends first.
+     */
+    template <typename T>
+    void read_array(T * out, size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only plain values can be read");
+        read_bytes(out, count * sizeof(T));
+    }
+
+    /**
+     * @return `std::uint64_t` The file size a snapshot with `header` has.
+     */
+    static std::uint64_t get_file_size(const SnapshotHeader & header);
+
+private:
+    void read_bytes(void * bytes, size_t size);
+};
+
+} // namespace LCode
+
+#endif // LCODE_SNAPSHOT_HPP
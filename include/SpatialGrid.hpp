@@ -0,0 +1,170 @@
+/**
+ * @file    SpatialGrid.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   SpatialGrid class - A uniform grid of square buckets over the
+ *          world, rebuilt from a list of points every tick with a counting
+ *          sort. Finds the points near a position, or every pair of points
+ *          that may touch, by only looking at neighbouring buckets instead
+ *          of comparing every point against every other.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_SPATIALGRID_HPP
+#define LCODE_SPATIALGRID_HPP
+
+#include "lilyutils.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+class SpatialGrid
+{
+    // side length of a bucket, and its inverse to avoid dividing
+    float cell_size;
+    float inv_cell_size;
+    int columns, rows;
+
+    // `items[cell_start[c]]` up to `items[cell_start[c + 1]]` are the points
+    // in bucket c, in ascending order (32-bit to keep the arrays compact)
+    std::vector<std::uint32_t> cell_start;
+    std::vector<std::uint32_t> items;
+    // scratch for `build()`: the bucket of each point, then insert positions
+    std::vector<std::uint32_t> item_cells;
+    std::vector<std::uint32_t> cursors;
+
+public:
+    /**
+     * @param bucket_size Side length of a bucket. `for_each_pair()` only
+     *                    finds pairs closer than this, so use the largest
+     *                    distance that matters (e.g. the biggest diameter).
+     */
+    explicit SpatialGrid(float bucket_size);
+    // Out of line, the owner's destructor doesn't need four vector frees inlined.
+    ~SpatialGrid();
+
+    void set_cell_size(float bucket_size);
+    float get_cell_size() const;
+
+    /**
+     * @brief Sorts `count` points into buckets covering a `width` by
+     *        `height` area. Points outside of it go in the nearest edge
+     *        bucket. Indices passed to visitors are positions in `xs/ys`.
+     */
+    void build(const float * xs, const float * ys, size_t count, float width, float height);
+
+    /**
+     * @brief Calls `visit(index)` for every point in the buckets that the
+     *        square of half-size `range` around (x, y) touches. Some visited
+     *        points may be further than `range` away.
+     */
+    template <typename Visit>
+    void query(float x, float y, float range, Visit && visit) const
+    {
+        query_rect(x - range, y - range, x + range, y + range, visit);
+    }
+
+    /**
+     * @brief Calls `visit(index)` for every point in the buckets that the
+     *        rectangle from (left, top) to (right, bottom) touches, bucket
+     *        by bucket. Some visited points may be outside of it.
+     */
+    template <typename Visit>
+    void query_rect(float left, float top, float right, float bottom, Visit && visit) const
+    {
+        int first_col = get_column(left), last_col = get_column(right);
+        int first_row = get_row(top), last_row = get_row(bottom);
+        for (int row = first_row; row <= last_row; ++row)
+        {
+            for (int col = first_col; col <= last_col; ++col)
+            {
+                size_t cell = static_cast<size_t>(row * columns + col);
+                for (std::uint32_t i = cell_start[cell]; i < cell_start[cell + 1]; ++i)
+                {
+                    visit(static_cast<size_t>(items[i]));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Calls `visit(a, b)` once for every pair of points in the same or
+     *        adjacent buckets, which includes every pair closer than the
+     *        bucket size. The order only depends on the points' positions.
+     */
+    template <typename Visit>
+    void for_each_pair(Visit && visit) const
+    {
+        // each bucket pairs with itself and the neighbours after it, so every
+        // adjacent pair of buckets is only visited once
+        static const int NEIGHBOURS[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < columns; ++col)
+            {
+                size_t cell = static_cast<size_t>(row * columns + col);
+                std::uint32_t begin = cell_start[cell], end = cell_start[cell + 1];
+                for (std::uint32_t i = begin; i < end; ++i)
+                {
+                    for (std::uint32_t j = i + 1; j < end; ++j)
+                    {
+                        visit(static_cast<size_t>(items[i]), static_cast<size_t>(items[j]));
+                    }
+                }
+                for (const int * offset : NEIGHBOURS)
+                {
+                    int other_col = col + offset[0], other_row = row + offset[1];
+                    if (other_col < 0 || other_col >= columns || other_row >= rows)
+                    {
+                        continue;
+                    }
+                    size_t other = static_cast<size_t>(other_row * columns + other_col);
+                    for (std::uint32_t i = begin; i < end; ++i)
+                    {
+                        for (std::uint32_t j = cell_start[other]; j < cell_start[other + 1]; ++j)
+                        {
+                            visit(static_cast<size_t>(items[i]), static_cast<size_t>(items[j]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int get_columns() const;
+    int get_rows() const;
+    size_t get_item_count() const;
+
+    /**
+     * @return `size_t` The most points in one bucket, a bucket size much
+     *         smaller than the points are spaced makes pair searches slow.
+     */
+    size_t get_max_occupancy() const;
+
+private:
+    int get_column(float x) const
+    {
+        return grid_index(x, inv_cell_size, static_cast<float>(columns - 1));
+    }
+
+    int get_row(float y) const
+    {
+        return grid_index(y, inv_cell_size, static_cast<float>(rows - 1));
+    }
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_SPATIALGRID_HPP
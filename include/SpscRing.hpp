@@ -0,0 +1,117 @@
+/**
+ * @file    SpscRing.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   SpscRing class - A fixed-size lock-free queue between exactly one
+ *          producer thread and one consumer thread. Pushing never waits and
+ *          never allocates, it fails instead when the ring is full, so the
+ *          producer can be a frame loop that must not stall.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_SPSCRING_HPP
+#define LCODE_SPSCRING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace LCode
+{
+
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+    // Bytes the indices are kept apart by, so the producer and consumer
+    // don't keep taking the same cache line from each other.
+    static inline const size_t CACHE_LINE = 64;
+    static inline const size_t MASK = Capacity - 1;
+
+    // next slot to write, only stored by the producer, and the producer's
+    // last look at `tail` so it only reloads it when the ring seems full
+    alignas(CACHE_LINE) std::atomic<size_t> head;
+    size_t cached_tail;
+    // next slot to read, only stored by the consumer, and its last look at `head`
+    alignas(CACHE_LINE) std::atomic<size_t> tail;
+    size_t cached_head;
+    // indices grow forever, the slot is the index masked by the capacity
+    alignas(CACHE_LINE) std::array<T, Capacity> slots;
+
+public:
+    SpscRing()
+    : head{0}, cached_tail{0}, tail{0}, cached_head{0}, slots{}
+    { }
+
+    SpscRing(const SpscRing & other) = delete;
+    SpscRing & operator = (const SpscRing & other) = delete;
+
+    /**
+     * @brief Copies `value` into the ring. Producer thread only.
+     * @return false without waiting if the ring is full.
+     */
+    bool try_push(const T & value)
+    {
+        size_t write = head.load(std::memory_order_relaxed);
+        if (write - cached_tail == Capacity)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (write - cached_tail == Capacity)
+            {
+                return false;
+            }
+        }
+        slots[write & MASK] = value;
+        // publishes the slot to the consumer
+        head.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Moves the oldest value into `out`. Consumer thread only.
+     * @return false without waiting if the ring is empty.
+     */
+    bool try_pop(T & out)
+    {
+        size_t read = tail.load(std::memory_order_relaxed);
+        if (read == cached_head)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (read == cached_head)
+            {
+                return false;
+            }
+        }
+        out = slots[read & MASK];
+        // hands the slot back to the producer
+        tail.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @return `size_t` Values waiting to be popped, only exact when
+     *         neither thread is using the ring.
+     */
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_SPSCRING_HPP
@@ -0,0 +1,154 @@
+/**
+ * @file    Telemetry.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   TelemetryWriter class - Exports one `TelemetryRecord` of
+ *          population stats per frame for offline analysis. The frame loop
+ *          only copies the record into a lock-free `SpscRing`, and a
+ *          background thread drains it in batches into a CSV or binary
+ *          file, so disk writes never stall a frame. Records are dropped
+ *          (and counted) instead of waiting when the writer falls behind.
+ *
+ *          The binary format is a 4-byte "LTEL" magic, the `uint32_t`
+ *          version and record size, then every record as it is laid out
+ *          in memory (host byte order).
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_TELEMETRY_HPP
+#define LCODE_TELEMETRY_HPP
+
+#include "SpscRing.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+/**
+ * @brief Population stats of one frame.
+ */
+struct TelemetryRecord
+{
+    // Frame number since the run started.
+    std::uint64_t frame = 0;
+    // Milliseconds simulated during the frame, and the wall-clock frame time.
+    double sim_ms = 0.0,
+           frame_ms = 0.0;
+    // Entities, and cells (individual and swarm cells).
+    std::uint64_t entities = 0,
+                  cells = 0;
+    // Entities and swarm cells added and removed during the frame.
+    std::uint64_t births = 0,
+                  deaths = 0;
+    // Average seconds of life left over every cell, 0 without cells.
+    double mean_life = 0.0;
+};
+
+static_assert(std::is_trivially_copyable_v<TelemetryRecord>, "TelemetryRecord is written raw");
+
+enum class TelemetryFormat
+{
+    CSV,
+    BINARY
+};
+
+class TelemetryWriter
+{
+public:
+    // Records the frame loop can get ahead of the writer by (about a
+    // minute at 60 FPS) before records are dropped.
+    static inline const size_t QUEUE_CAPACITY = 4096;
+    // How long the writer sleeps when there is nothing to write.
+    static inline const int IDLE_WAIT_MS = 5;
+    // Version written at the start of binary files.
+    static inline const std::uint32_t BINARY_VERSION = 1;
+
+private:
+    using Queue = SpscRing<TelemetryRecord, QUEUE_CAPACITY>;
+
+    std::ofstream file;
+    std::string path;
+    TelemetryFormat format;
+    // on the heap, it is too big for the stack and must stay 64-byte aligned
+    std::unique_ptr<Queue> queue;
+
+    // only used by the thread calling `push()`
+    std::uint64_t pushed, dropped;
+    // only stored by the writer thread
+    std::atomic<std::uint64_t> written;
+    std::atomic<bool> write_failed;
+    // tells the writer thread to drain the queue and stop
+    std::atomic<bool> stopping;
+    std::thread writer_thread;
+
+public:
+    /**
+     * @brief Creates the file at `file_path`, writes its header and starts
+     *        the writer thread. Throws `LException` if it can't be created.
+     */
+    TelemetryWriter(const std::string & file_path, TelemetryFormat file_format);
+
+    TelemetryWriter(const TelemetryWriter & other) = delete;
+    TelemetryWriter & operator = (const TelemetryWriter & other) = delete;
+
+    /**
+     * @brief Calls `close()`.
+     */
+    ~TelemetryWriter();
+
+    /**
+     * @brief Queues `record` for writing, from one thread only. Never waits.
+     * @return false if the queue was full and the record was dropped.
+     */
+    bool push(const TelemetryRecord & record);
+
+    /**
+     * @brief Writes every queued record and stops the writer thread.
+     *        Nothing can be pushed after it.
+     */
+    void close();
+
+    std::uint64_t get_pushed() const;
+    std::uint64_t get_dropped() const;
+    std::uint64_t get_written() const;
+
+    /**
+     * @return true if writing to the file failed (e.g. the disk is full).
+     */
+    bool has_failed() const;
+
+    const std::string & get_path() const;
+
+    /**
+     * @return `TelemetryFormat` CSV for paths ending in ".csv", binary otherwise.
+     */
+    static TelemetryFormat format_for(const std::string & file_path);
+
+private:
+    // Writer thread: drains the queue in batches until `stopping`.
+    void write_loop();
+
+    // Writes every record in the queue with one file write, returns how many.
+    size_t write_batch(std::string & buffer);
+};
+
+std::ostream & operator << (std::ostream & os, const TelemetryWriter & writer);
+
+} // namespace LCode
+
+#endif // LCODE_TELEMETRY_HPP
@@ -0,0 +1,119 @@
+/**
+ * @file    TextureCache.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   TextureCache class - Hands out shared handles to GPU images, so
+ *          every `LTexture` of the same image file, or of the same text in
+ *          the same font and color, uses one `GPU_Image` instead of loading
+ *          and uploading its own copy. The cache only keeps weak references:
+ *          an image is freed as soon as its last handle is dropped.
+ *
+ *          Images are created on the GPU context, so the cache is only
+ *          used from the thread that owns it.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_TEXTURECACHE_HPP
+#define LCODE_TEXTURECACHE_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+// Shared handle to a cached image, freed with the last handle.
+using ImageHandle = std::shared_ptr<GPU_Image>;
+
+/**
+ * @brief Hits and misses since the last `TextureCache::reset_stats()`.
+ */
+struct TextureCacheStats
+{
+    std::uint64_t hits = 0,
+                  misses = 0;
+    // Cached images with at least one handle still alive.
+    size_t live = 0;
+};
+
+class TextureCache
+{
+    // Text images are keyed by the text and everything it was rendered with.
+    struct TextKey
+    {
+        std::string text{};
+        TTF_Font * font = nullptr;
+        SDL_Color color{};
+
+        bool operator == (const TextKey & other) const;
+    };
+
+    struct TextKeyHash
+    {
+        size_t operator () (const TextKey & key) const;
+    };
+
+    // Expired entries are only erased once a map grows this big, then
+    // once it doubles again, so a miss doesn't scan the whole map.
+    static inline const size_t MIN_PRUNE_SIZE = 64;
+
+    static std::unordered_map<std::string, std::weak_ptr<GPU_Image>> images;
+    static std::unordered_map<TextKey, std::weak_ptr<GPU_Image>, TextKeyHash> texts;
+    static size_t images_prune_size, texts_prune_size;
+    static std::uint64_t hits, misses;
+
+public:
+    TextureCache() = delete;
+
+    /**
+     * @brief Retrieves the image file at `path`, loading it on a miss.
+     *        Throws `LException` if it can't be loaded.
+     */
+    static ImageHandle load_image(const std::string & path);
+
+    /**
+     * @brief Retrieves `text` rendered in `font` and `color`, rendering it
+     *        on a miss. Throws `LException` if it can't be rendered.
+     */
+    static ImageHandle load_text(const std::string & text, TTF_Font * font, SDL_Color color);
+
+    static TextureCacheStats get_stats();
+    static void reset_stats();
+
+    /**
+     * @brief Forgets every cached image. Images still in use stay alive
+     *        until their last handle is dropped, but are loaded again on
+     *        the next request. Call when fonts or the GPU context are
+     *        destroyed, so nothing is looked up by a stale font pointer.
+     */
+    static void clear();
+
+private:
+    // Wraps a newly created image in a handle that frees it.
+    static ImageHandle make_handle(GPU_Image * image);
+
+    // Erases entries whose image was freed, if `map` outgrew `prune_size`.
+    template <typename MapT>
+    static void prune(MapT & map, size_t & prune_size);
+};
+
+std::ostream & operator << (std::ostream & os, const TextureCacheStats & stats);
+
+} // namespace LCode
+
+
+#endif // LCODE_TEXTURECACHE_HPP
@@ -0,0 +1,103 @@
+/**
+ * @file    ThreadPool.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   ThreadPool class - A fixed set of worker threads that split
+ *          index ranges between them. `parallel_for` hands out chunks from
+ *          a shared atomic counter, so threads that finish early keep
+ *          taking work until the whole range is done.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_THREADPOOL_HPP
+#define LCODE_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+class ThreadPool
+{
+public:
+    // Work function, called with a [begin, end) range of indices.
+    using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+private:
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+
+    // -------- the job currently being run, guarded by `mutex` --------
+    const RangeFunction * job;
+    size_t job_count;
+    size_t job_chunk;
+    std::atomic<size_t> next_index;
+    // workers that have not finished the current job yet
+    size_t busy_workers;
+    // incremented for every job so workers can tell a new one started
+    unsigned long long generation;
+    // first exception thrown by the current job, rethrown by `parallel_for`
+    std::exception_ptr job_error;
+    bool stopping;
+
+public:
+    /**
+     * @param thread_count Total threads to run jobs on, including the thread
+     *                     calling `parallel_for`. 0 uses every hardware thread.
+     */
+    explicit ThreadPool(size_t thread_count = 0);
+
+    ThreadPool(const ThreadPool & other) = delete;
+    ThreadPool & operator = (const ThreadPool & other) = delete;
+
+    /**
+     * @brief Stops and joins every worker thread.
+     */
+    ~ThreadPool();
+
+    /**
+     * @return `size_t` Threads used by `parallel_for`, including the caller.
+     */
+    size_t get_thread_count() const;
+
+    /**
+     * @brief Calls `body` on chunks of [0, count) spread across every thread
+     *        and blocks until they have all finished. Runs `body(0, count)`
+     *        on the calling thread if there is only one chunk, only one
+     *        thread, or when called from inside another `parallel_for`.
+     *
+     * @param count The number of indices to process.
+     * @param chunk The number of indices handed to a thread at a time.
+     * @param body  The work to do for each [begin, end) range.
+     */
+    void parallel_for(size_t count, size_t chunk, const RangeFunction & body);
+
+    /**
+     * @return `size_t` The number of hardware threads (at least 1).
+     */
+    static size_t hardware_threads();
+
+private:
+    void worker_loop();
+    void run_chunks();
+};
+
+} // namespace LCode
+
+#endif // LCODE_THREADPOOL_HPP
@@ -3,19 +3,58 @@
 #define LCODE_CELL_HPP
 
 #include "LEntity.hpp"
-#include "LTexture.hpp"
+#include "Snapshot.hpp"
+#include "entities/CellSpriteCache.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 namespace LCode
 {
 
+/**
+ * @brief Level of detail a cell is drawn at, from how big it is on screen.
+ */
+enum class CellLod
+{
+    // Fill, outline and HP label
+    FULL,
+    // Fill and outline, no label
+    REDUCED,
+    // A single quad of the fill color
+    MINIMAL,
+    COUNT
+};
+
+const char * to_string(CellLod lod);
+
+/**
+ * @brief On-screen radii (in pixels) where cells switch detail levels.
+ */
+struct CellLodThresholds
+{
+    // Cells at least this big on screen are drawn at `CellLod::FULL`.
+    float full_radius = 24.0f;
+    // Cells smaller than this on screen are drawn at `CellLod::MINIMAL`.
+    float minimal_radius = 3.0f;
+};
+
 class Cell : public LEntity
 {
     static inline SDL_Color BLACK{0x00, 0x00, 0x00, 0xFF};
     static inline SDL_Color WHITE{0xFF, 0xFF, 0xFF, 0xFF};
 
+    // how every cell is drawn
+    static inline CellRenderMode render_mode = CellRenderMode::GEOMETRY;
+    // where cells switch detail levels, and how many were drawn at each
+    // level since `reset_lod_counts()`
+    static inline CellLodThresholds lod_thresholds{};
+    static inline std::array<size_t, static_cast<size_t>(CellLod::COUNT)> lod_counts{};
+
     SDL_FPoint velocity;
 
     SDL_Color color;
@@ -27,15 +66,75 @@ class Cell : public LEntity
     double life,
            life_total;
 
-    LTexture text_label;
+    // detail level of the last draw, the label is only drawn at FULL
+    CellLod lod;
 
 public:
+    // Range of random cell radii
+    static inline const Sint16 MIN_RADIUS = 16;
+    static inline const Sint16 MAX_RADIUS = 128;
+    // Characters the "HP: x / y" label is built in, on the stack
+    static inline const size_t LABEL_CAPACITY = 32;
+
     Cell();
     Cell(SDL_FPoint new_pos);
     Cell(float x, float y);
+    // Restores a cell saved with `to_record()`.
+    explicit Cell(const CellRecord & record);
 
-    void update(double delta_ms) override;
+    void update(const FrameContext & context) override;
     void draw(GPU_Target * gpu) override;
+    void draw_overlay(GPU_Target * gpu) override;
+    std::uint64_t get_state_hash() const override;
+    SDL_FRect get_bounds() const override;
+
+    float get_radius() const;
+
+    /**
+     * @return `double` Seconds of life left.
+     */
+    double get_life() const;
+
+    /**
+     * @return `CellRecord` Everything about this cell a snapshot stores.
+     */
+    CellRecord to_record() const;
+
+    /**
+     * @brief Pushes this cell and `other` apart if they overlap, turning
+     *        each away from the other. Cells keep their speed.
+     *
+     * @return true if they overlapped.
+     */
+    bool collide(Cell & other);
+
+    static void set_render_mode(CellRenderMode mode);
+    static CellRenderMode get_render_mode();
+
+    /**
+     * @brief Sets the on-screen radii cells switch detail levels at.
+     *        `full_radius` is raised to `minimal_radius` if it is below it.
+     */
+    static void set_lod_thresholds(const CellLodThresholds & thresholds);
+    static const CellLodThresholds & get_lod_thresholds();
+
+    /**
+     * @return `CellLod` The detail to draw a cell `screen_radius` pixels
+     *         big on screen at.
+     */
+    static CellLod get_lod(float screen_radius);
+
+    /**
+     * @brief Adds `count` cells drawn at `lod` to the counts.
+     */
+    static void count_lod(CellLod lod, size_t count = 1);
+
+    /**
+     * @return The number of cells drawn at each `CellLod` (in order) since
+     *         the last `reset_lod_counts()`, swarm cells included.
+     */
+    static const std::array<size_t, static_cast<size_t>(CellLod::COUNT)> & get_lod_counts();
+    static void reset_lod_counts();
 };
 
 } // namespace LCode
@@ -0,0 +1,97 @@
+/**
+ * @file    CellSpriteCache.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   CellSpriteCache class - Every cell radius pre-rasterized once into
+ *          a single white atlas image, as a fill mask and an outline. Cells
+ *          are then drawn as two tinted blits from the same image, which
+ *          SDL_gpu batches together, instead of tessellated geometry.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_CELLSPRITECACHE_HPP
+#define LCODE_CELLSPRITECACHE_HPP
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <memory>
+#include <vector>
+
+namespace LCode
+{
+
+/**
+ * @brief How cells are drawn, switchable at runtime for comparison.
+ */
+enum class CellRenderMode
+{
+    // Triangles tessellated into the frame's `ShapeBatch`
+    GEOMETRY,
+    // Tinted blits from the `CellSpriteCache` atlas
+    SPRITES
+};
+
+const char * to_string(CellRenderMode mode);
+
+
+class CellSpriteCache
+{
+    // the cache shared by every cell, built on first use
+    static std::unique_ptr<CellSpriteCache> instance;
+
+    GPU_Image * image;
+    // where each radius' sprites are in `image`, indexed by `radius - min_radius`
+    std::vector<GPU_Rect> fill_rects;
+    std::vector<GPU_Rect> outline_rects;
+    int min_radius,
+        max_radius;
+
+public:
+    /**
+     * @brief Rasterizes the fill and outline of every radius in
+     *        [min_radius, max_radius] and uploads them as one image.
+     *        Prefer `get()`, which builds the cache only once.
+     */
+    CellSpriteCache(int min_radius, int max_radius);
+
+    CellSpriteCache(const CellSpriteCache & other) = delete;
+    CellSpriteCache & operator = (const CellSpriteCache & other) = delete;
+
+    ~CellSpriteCache();
+
+    /**
+     * @brief Retrieves the cache for the `Cell` radius range,
+     *        building it on first use.
+     */
+    static CellSpriteCache & get();
+
+    /**
+     * @brief Frees the shared cache. Call before the GPU context is destroyed.
+     */
+    static void free();
+
+    /**
+     * @return `int` How wide the outline of a cell with `radius` is.
+     */
+    static int get_outline_width(int radius);
+
+    bool has_radius(int radius) const;
+
+    /**
+     * @brief Draws a cell of `radius` centered on (x, y), tinting its fill
+     *        and outline with the given colors.
+     */
+    void draw(GPU_Target * gpu, float x, float y, int radius,
+              SDL_Color fill_color, SDL_Color outline_color);
+};
+
+} // namespace LCode
+
+#endif // LCODE_CELLSPRITECACHE_HPP
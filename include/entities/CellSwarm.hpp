@@ -0,0 +1,229 @@
+/**
+ * @file    CellSwarm.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   CellSwarm class - A single entity that simulates many cells at
+ *          once. Cell properties are stored as a structure of arrays so the
+ *          update kernel can step 4 (SSE) or 8 (AVX) cells per instruction,
+ *          instead of one virtual `Cell::update` call per cell.
+ *          Cells can also push each other apart, found through a
+ *          `SpatialGrid` instead of testing every pair, and only the cells
+ *          in view of the camera are drawn, found through the same grid.
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_CELLSWARM_HPP
+#define LCODE_CELLSWARM_HPP
+
+#include "LEntity.hpp"
+#include "SpatialGrid.hpp"
+#include "Snapshot.hpp"
+#include "NutrientField.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+class CellSwarm : public LEntity
+{
+    static inline SDL_Color BLACK{0x00, 0x00, 0x00, 0xFF};
+
+    // values shared by every cell during one update
+    struct StepParams
+    {
+        float delta_sec = 0.0f;
+        float step_scale = 1.0f;
+        float world_w = 0.0f;
+        float world_h = 0.0f;
+        // the field cells feed from, nullptr without one
+        const NutrientField * nutrients = nullptr;
+    };
+
+    // -------- per-cell arrays, all the same length --------
+    std::vector<float> pos_x, pos_y;
+    // positions before the latest tick, drawn blended towards `pos_x/y`
+    std::vector<float> prev_x, prev_y;
+    std::vector<float> vel_x, vel_y;
+    std::vector<float> speeds;
+    std::vector<float> radii;
+    std::vector<float> lives, life_totals;
+    std::vector<SDL_Color> colors;
+    // `lives` added up by the update kernels, and kept as cells are added
+    // and removed in between
+    double total_life;
+
+    // indices of cells at or below 0 life after the last update
+    std::vector<size_t> dying;
+    // cells removed for running out of life since the swarm was created
+    std::uint64_t died;
+    // `dying` and the life left per chunk while the update is split across threads
+    std::vector<std::vector<size_t>> chunk_dying;
+    std::vector<double> chunk_life;
+
+    // false forces the scalar kernel, to compare against the SIMD one
+    bool use_simd;
+
+    // cells bucketed by position, rebuilt every update when colliding
+    // and before drawing if cells moved since it was built
+    SpatialGrid grid;
+    bool grid_current;
+    // true to push overlapping cells apart after moving them
+    bool collisions;
+    // overlapping pairs separated during the last update
+    size_t overlaps;
+
+    // indices of the cells drawn this frame, in order, and the cells
+    // marked in view while they are found bucket by bucket
+    std::vector<size_t> visible;
+    std::vector<Uint8> visible_mask;
+
+public:
+    // Name of the SIMD kernel compiled in ("AVX", "SSE2" or "scalar").
+    static const char * const SIMD_NAME;
+
+    CellSwarm();
+    // Out of line, inlining every array's destructor isn't worth it.
+    ~CellSwarm() override;
+
+    /**
+     * @brief Adds a cell at the given position with randomized color,
+     *        radius, speed, direction and life, like a new `Cell`.
+     */
+    void add_cell(float x, float y);
+
+    /**
+     * @brief Adds `count` randomized cells at random world positions.
+     */
+    void add_random_cells(size_t count);
+
+    size_t size() const;
+
+    /**
+     * @return `std::uint64_t` Cells that ran out of life and were removed
+     *         since the swarm was created.
+     */
+    std::uint64_t get_died() const;
+
+    /**
+     * @return `double` The life left of every cell added up, in seconds.
+     */
+    double get_total_life() const;
+
+    /**
+     * @brief Writes every cell's properties, one array at a time, in the
+     *        order `load_snapshot()` reads them.
+     */
+    void save_snapshot(SnapshotWriter & writer) const;
+
+    /**
+     * @brief Replaces every cell with `count` cells read from `reader`,
+     *        each array in one read.
+     */
+    void load_snapshot(SnapshotReader & reader, size_t count);
+
+    /**
+     * @brief Counts every cell as eating from `nutrients` this tick.
+     */
+    void add_demand_to(NutrientField & nutrients) const;
+
+    void set_simd(bool enabled);
+    bool is_simd() const;
+
+    void set_collisions(bool enabled);
+    bool has_collisions() const;
+
+    /**
+     * @return `size_t` The overlapping pairs of cells pushed apart during
+     *         the last update (0 without collisions).
+     */
+    size_t get_overlaps() const;
+
+    /**
+     * @return `size_t` The number of cells in view during the last draw.
+     */
+    size_t get_drawn() const;
+
+    void update(const FrameContext & context) override;
+    void draw(GPU_Target * gpu) override;
+    void save_previous_state() override;
+    std::uint64_t get_state_hash() const override;
+    // The whole world, since cells can be anywhere in it.
+    SDL_FRect get_bounds() const override;
+    // The swarm splits its cells across the update threads itself.
+    bool splits_own_update() const override;
+
+private:
+    /**
+     * @brief Runs the SIMD kernel (if enabled) and then the scalar kernel
+     *        over cells [begin, end), appending dying cells to `dying_out`.
+     *
+     * @return `double` The life the cells have left, added up.
+     */
+    double update_range(size_t begin, size_t end, const StepParams & params,
+                        std::vector<size_t> & dying_out);
+
+    /**
+     * @brief Adds the life cells [begin, end) gain from the grid cell they
+     *        are in, up to their starting life.
+     */
+    void feed(size_t begin, size_t end, const NutrientField & nutrients, float delta_sec);
+
+    /**
+     * @brief Decays life, integrates positions and reflects off the world
+     *        edges for cells [begin, end) one at a time, adding the life
+     *        they have left to `life_out`.
+     */
+    void update_scalar(size_t begin, size_t end, const StepParams & params,
+                       std::vector<size_t> & dying_out, double & life_out);
+
+    /**
+     * @brief Same as `update_scalar` using SIMD intrinsics, returns the
+     *        index where it stopped (the leftover tail is done by scalar).
+     */
+    size_t update_simd(size_t begin, size_t end, const StepParams & params,
+                       std::vector<size_t> & dying_out, double & life_out);
+
+    /**
+     * @brief Appends `first + lane` to `dying_out` for each bit set in `lane_mask`.
+     */
+    static void record_dying(std::vector<size_t> & dying_out, size_t first, int lane_mask);
+
+    /**
+     * @brief Swap-and-pops dead cells out of every array. Only visits the
+     *        cells recorded in `dying`.
+     */
+    void remove_dead();
+
+    /**
+     * @brief Rebuilds `grid` and separates every pair of overlapping cells,
+     *        in an order that only depends on the cells' positions.
+     */
+    void resolve_overlaps();
+
+    // Builds `grid` from the current positions unless it is up to date.
+    void update_grid();
+
+    /**
+     * @brief Fills `visible` with the cells that overlap `view`, in order.
+     */
+    void find_visible(const SDL_FRect & view);
+
+    void remove_cell(size_t index);
+};
+
+} // namespace LCode
+
+
+#endif // LCODE_CELLSWARM_HPP
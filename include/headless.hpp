@@ -0,0 +1,78 @@
+/**
+ * @file    headless.hpp
+ * @author  Lily-Heather Crawford @bipsydev
+ *
+ * @brief   Configuration and result types for running an `SDLBaseGame`
+ *          without a window, GPU context or fonts (see
+ *          `SDLBaseGame::run_headless()`).
+ *
+ * @version 0.1
+ * @date    2023-11-25
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+
+#pragma once
+#ifndef LCODE_HEADLESS_HPP
+#define LCODE_HEADLESS_HPP
+
+#include <iostream>
+#include <cstddef>
+
+namespace LCode
+{
+
+/**
+ * @brief Stop conditions and timing for a headless run. At least one of
+ *        `max_frames` or `max_sim_seconds` must be positive.
+ */
+struct HeadlessConfig
+{
+    // Stop after this many update steps (0 = no frame limit).
+    int max_frames = 0;
+    // Stop after this much simulated time has passed (0 = no time limit).
+    double max_sim_seconds = 0.0;
+    // Fixed delta passed to every update in ms (0 = measure wall-clock delta).
+    double fixed_delta_ms = 0.0;
+};
+
+/**
+ * @brief Summary of a finished headless run.
+ */
+struct HeadlessReport
+{
+    // Number of update steps that were run.
+    int frames = 0;
+    // Total simulated time (sum of every delta) in seconds.
+    double sim_seconds = 0.0;
+    // Real time spent running the update steps in seconds.
+    double wall_seconds = 0.0;
+    // Update steps per real second.
+    double steps_per_sec = 0.0;
+    // Entity counts at the start, end, and the highest seen during the run.
+    size_t start_entities = 0,
+           end_entities = 0,
+           peak_entities = 0;
+    // Total entities removed over the run.
+    size_t removed_entities = 0;
+    // Threads that entities were updated with.
+    size_t update_threads = 1;
+};
+
+inline std::ostream & operator << (std::ostream & os, const HeadlessReport & report)
+{
+    return os << "threads:       " << report.update_threads << "\n"
+              << "frames:        " << report.frames << "\n"
+              << "sim time:      " << report.sim_seconds << " s\n"
+              << "wall time:     " << report.wall_seconds << " s\n"
+              << "steps/sec:     " << report.steps_per_sec << "\n"
+              << "entities:      " << report.start_entities << " -> "
+                                   << report.end_entities
+                                   << " (peak " << report.peak_entities << ")\n"
+              << "removed:       " << report.removed_entities << "\n";
+}
+
+} // namespace LCode
+
+#endif // LCODE_HEADLESS_HPP
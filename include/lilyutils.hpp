@@ -2,20 +2,153 @@
 #ifndef LCODE_LILYUTILS_HPP
 #define LCODE_LILYUTILS_HPP
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace LCode
 {
 
+/**
+ * @brief Writes `val` rounded to `decimal_spaces` into [first, last),
+ *        without allocating. Nothing is null-terminated.
+ *
+ * @return `char *` One past the last character written, or `first` if
+ *         the number didn't fit.
+ */
+inline char * format_fixed(char * first, char * last, double val, int decimal_spaces) noexcept
+{
+    std::to_chars_result result = std::to_chars(first, last, val, std::chars_format::fixed,
+                                                decimal_spaces);
+    return result.ec == std::errc{}? result.ptr : first;
+}
+
 inline std::string round_to(double val, unsigned short decimal_spaces) noexcept
 {
-    double rounded_val = round(val * pow(10, decimal_spaces)) / pow(10, decimal_spaces);
-    std::string rounded_str = std::to_string(rounded_val);
-    size_t end_pos = std::min(rounded_str.length(),
-                              rounded_str.find('.') + decimal_spaces + (decimal_spaces > 0? 1 : 0));
-    return rounded_str.substr(0, end_pos);
+    std::array<char, 64> buffer;
+    char * end = format_fixed(buffer.data(), buffer.data() + buffer.size(), val, decimal_spaces);
+    if (end == buffer.data())
+    {
+        // too long for the buffer, only huge numbers or precisions get here
+        return std::to_string(val);
+    }
+    return std::string{buffer.data(), end};
+}
+
+/**
+ * @brief Fixed-size text built on the stack, for labels and HUD text that
+ *        are rebuilt often. Appending never allocates: text past the
+ *        capacity is cut off, and numbers that don't fit are left out.
+ */
+template <size_t Capacity>
+class TextBuffer
+{
+    std::array<char, Capacity> chars;
+    size_t length;
+
+public:
+    TextBuffer() noexcept
+    : chars{}, length{0}
+    { }
+
+    TextBuffer & append(std::string_view text) noexcept
+    {
+        size_t count = std::min(text.size(), Capacity - length);
+        std::memcpy(chars.data() + length, text.data(), count);
+        length += count;
+        return *this;
+    }
+
+    /**
+     * @brief Appends `value` rounded to `decimal_spaces`, like `round_to`.
+     */
+    TextBuffer & append(double value, int decimal_spaces) noexcept
+    {
+        char * first = chars.data() + length;
+        length += static_cast<size_t>(format_fixed(first, chars.data() + Capacity,
+                                                   value, decimal_spaces) - first);
+        return *this;
+    }
+
+    template <typename IntT, typename = std::enable_if_t<std::is_integral_v<IntT>>>
+    TextBuffer & append(IntT value) noexcept
+    {
+        std::to_chars_result result = std::to_chars(chars.data() + length,
+                                                    chars.data() + Capacity, value);
+        if (result.ec == std::errc{})
+        {
+            length = static_cast<size_t>(result.ptr - chars.data());
+        }
+        return *this;
+    }
+
+    void clear() noexcept
+    {
+        length = 0;
+    }
+
+    size_t size() const noexcept
+    {
+        return length;
+    }
+
+    std::string_view view() const noexcept
+    {
+        return std::string_view{chars.data(), length};
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return view();
+    }
+};
+
+/**
+ * @brief Mixes `value` into the running 64-bit `hash`, order dependent.
+ */
+inline std::uint64_t hash_combine(std::uint64_t hash, std::uint64_t value) noexcept
+{
+    hash ^= value + 0x9E3779B97F4A7C15 + (hash << 6) + (hash >> 2);
+    hash = (hash ^ (hash >> 31)) * 0xBF58476D1CE4E5B9;
+    return hash ^ (hash >> 29);
+}
+
+/**
+ * @brief Mixes the exact bits of `value` into `hash`, so any change
+ *        to a float (even in the last place) changes the result.
+ */
+inline std::uint64_t hash_combine(std::uint64_t hash, float value) noexcept
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hash_combine(hash, std::uint64_t{bits});
+}
+
+inline std::uint64_t hash_combine(std::uint64_t hash, double value) noexcept
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return hash_combine(hash, bits);
+}
+
+/**
+ * @return `int` The grid column (or row) that `coord` falls in, for grid
+ *         cells `1 / inv_cell_size` wide, clamped to [0, `last_index`].
+ *         Clamped as floats first, so far off positions can't overflow an
+ *         int, with min/max since they compile to branchless instructions
+ *         where `std::clamp` doesn't.
+ */
+inline int grid_index(float coord, float inv_cell_size, float last_index) noexcept
+{
+    return static_cast<int>(std::min(std::max(coord * inv_cell_size, 0.0f), last_index));
 }
 
 } // LCode
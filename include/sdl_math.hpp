@@ -19,6 +19,11 @@ inline SDL_FPoint operator * (float a, SDL_FPoint vec)
     return SDL_FPoint{vec.x * a, vec.y * a};
 }
 
+inline SDL_FPoint operator + (SDL_FPoint vec1, SDL_FPoint vec2)
+{
+    return SDL_FPoint{vec1.x + vec2.x, vec1.y + vec2.y};
+}
+
 inline SDL_FPoint operator - (SDL_FPoint vec1, SDL_FPoint vec2)
 {
     return SDL_FPoint{vec1.x - vec2.x, vec1.y - vec2.y};
@@ -34,5 +39,35 @@ inline SDL_FPoint reflect(SDL_FPoint vec, SDL_FPoint surf_norm)
     return vec - 2.0f * dot_prod(vec, surf_norm) * surf_norm;
 }
 
+// Pushes two overlapping circles apart along the line between their centers,
+// half the overlap each, and reflects each direction that heads into the
+// other circle. Returns false (changing nothing) if they don't overlap.
+inline bool separate_circles(SDL_FPoint & pos1, SDL_FPoint & dir1, float radius1,
+                             SDL_FPoint & pos2, SDL_FPoint & dir2, float radius2)
+{
+    SDL_FPoint between = pos2 - pos1;
+    float min_dist = radius1 + radius2;
+    float dist_sq = dot_prod(between, between);
+    if (dist_sq >= min_dist * min_dist)
+    {
+        return false;
+    }
+    float dist = std::sqrt(dist_sq);
+    // circles exactly on top of each other are split along the x-axis
+    SDL_FPoint normal = dist > 0.0f? (1.0f / dist) * between : EAST;
+    float push = (min_dist - dist) / 2.0f;
+    pos1 = pos1 - push * normal;
+    pos2 = pos2 + push * normal;
+    if (dot_prod(dir1, normal) > 0.0f)
+    {
+        dir1 = reflect(dir1, normal);
+    }
+    if (dot_prod(dir2, normal) < 0.0f)
+    {
+        dir2 = reflect(dir2, normal);
+    }
+    return true;
+}
+
 
 #endif // LCODE_SDL_MATH_HPP
\ No newline at end of file
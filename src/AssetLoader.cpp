@@ -0,0 +1,128 @@
+#include "AssetLoader.hpp"
+#include "LException.hpp"
+#include "LTimer.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_image.h>
+
+#include <future>
+#include <mutex>
+#include <string>
+
+namespace LCode
+{
+
+AssetLoader::AssetLoader()
+: init_mutex{}, ttf_initialized{false}, image_initialized{false}
+{ }
+
+AssetLoader::~AssetLoader()
+{
+    quit();
+}
+
+std::future<LoadedFont> AssetLoader::load_font_async(const std::string & path, int point_size)
+{
+    return std::async(std::launch::async, [this, path, point_size]
+    {
+        return load_font(path, point_size);
+    });
+}
+
+std::future<LoadedSurface> AssetLoader::load_surface_async(const std::string & path)
+{
+    return std::async(std::launch::async, [this, path]
+    {
+        return load_surface(path);
+    });
+}
+
+LoadedFont AssetLoader::load_font(const std::string & path, int point_size)
+{
+    LTimer timer;
+    timer.start();
+    require_ttf();
+    LoadedFont loaded;
+    loaded.asset = TTF_OpenFont(path.c_str(), point_size);
+    if (loaded.asset == nullptr)
+    {
+        throw LException{"Failed to load font \"" + path + "\"! SDL_ttf Error: "
+                         + std::string{TTF_GetError()} + '\n'};
+    }
+    loaded.load_ms = timer.get_ms();
+    return loaded;
+}
+
+LoadedSurface AssetLoader::load_surface(const std::string & path)
+{
+    LTimer timer;
+    timer.start();
+    require_image();
+    LoadedSurface loaded;
+    loaded.asset = IMG_Load(path.c_str());
+    if (loaded.asset == nullptr)
+    {
+        throw LException{"Unable to load image \"" + path + "\"! SDL_image Error: "
+                         + std::string{IMG_GetError()} + '\n'};
+    }
+    loaded.load_ms = timer.get_ms();
+    return loaded;
+}
+
+void AssetLoader::require_ttf()
+{
+    std::lock_guard<std::mutex> lock{init_mutex};
+    if (!ttf_initialized)
+    {
+        if (TTF_Init() < 0)
+        {
+            throw LException{"Could not initialize SDL_ttf for font loading! SDL_ttf Error: "
+                    + std::string{TTF_GetError()} + '\n'};
+        }
+        ttf_initialized = true;
+    }
+}
+
+void AssetLoader::require_image()
+{
+    std::lock_guard<std::mutex> lock{init_mutex};
+    if (!image_initialized)
+    {
+        if ( ! (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) )
+        {
+            throw LException{"Could not initialize SDL_image for PNG loading! SDL_image Error: "
+                    + std::string{IMG_GetError()} + '\n'};
+        }
+        image_initialized = true;
+    }
+}
+
+bool AssetLoader::is_ttf_initialized()
+{
+    std::lock_guard<std::mutex> lock{init_mutex};
+    return ttf_initialized;
+}
+
+bool AssetLoader::is_image_initialized()
+{
+    std::lock_guard<std::mutex> lock{init_mutex};
+    return image_initialized;
+}
+
+void AssetLoader::quit()
+{
+    std::lock_guard<std::mutex> lock{init_mutex};
+    if (ttf_initialized)
+    {
+        TTF_Quit();
+        ttf_initialized = false;
+    }
+    if (image_initialized)
+    {
+        IMG_Quit();
+        image_initialized = false;
+    }
+}
+
+} // namespace LCode
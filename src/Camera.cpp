@@ -0,0 +1,108 @@
+#include "Camera.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <algorithm>
+
+namespace LCode
+{
+
+Camera::Camera()
+: center{0.0f, 0.0f}, zoom{1.0f}, view_w{0.0f}, view_h{0.0f}
+{ }
+
+void Camera::set_viewport(int width, int height)
+{
+    view_w = static_cast<float>(width);
+    view_h = static_cast<float>(height);
+}
+
+void Camera::look_at(SDL_FPoint world_pos)
+{
+    center = world_pos;
+}
+
+SDL_FPoint Camera::get_center() const
+{
+    return center;
+}
+
+void Camera::pan(float screen_dx, float screen_dy)
+{
+    center.x += screen_dx / zoom;
+    center.y += screen_dy / zoom;
+}
+
+void Camera::set_zoom(float new_zoom)
+{
+    zoom = std::clamp(new_zoom, MIN_ZOOM, MAX_ZOOM);
+}
+
+float Camera::get_zoom() const
+{
+    return zoom;
+}
+
+void Camera::zoom_at(float factor, float screen_x, float screen_y)
+{
+    SDL_FPoint anchor = screen_to_world(SDL_FPoint{screen_x, screen_y});
+    set_zoom(zoom * factor);
+    // move the center so `anchor` lands back under the same screen position
+    center.x = anchor.x - (screen_x - view_w / 2.0f) / zoom;
+    center.y = anchor.y - (screen_y - view_h / 2.0f) / zoom;
+}
+
+void Camera::fit(const SDL_Rect & world)
+{
+    if (world.w > 0 && world.h > 0)
+    {
+        set_zoom(std::min(view_w / static_cast<float>(world.w),
+                          view_h / static_cast<float>(world.h)));
+    }
+    look_at(SDL_FPoint{static_cast<float>(world.x) + static_cast<float>(world.w) / 2.0f,
+                       static_cast<float>(world.y) + static_cast<float>(world.h) / 2.0f});
+}
+
+void Camera::clamp_to(const SDL_Rect & world)
+{
+    center.x = std::clamp(center.x, static_cast<float>(world.x),
+                          static_cast<float>(world.x + world.w));
+    center.y = std::clamp(center.y, static_cast<float>(world.y),
+                          static_cast<float>(world.y + world.h));
+}
+
+SDL_FRect Camera::get_view() const
+{
+    float world_w = view_w / zoom;
+    float world_h = view_h / zoom;
+    return SDL_FRect{center.x - world_w / 2.0f, center.y - world_h / 2.0f, world_w, world_h};
+}
+
+SDL_FPoint Camera::world_to_screen(SDL_FPoint world_pos) const
+{
+    return SDL_FPoint{(world_pos.x - center.x) * zoom + view_w / 2.0f,
+                      (world_pos.y - center.y) * zoom + view_h / 2.0f};
+}
+
+SDL_FPoint Camera::screen_to_world(SDL_FPoint screen_pos) const
+{
+    return SDL_FPoint{(screen_pos.x - view_w / 2.0f) / zoom + center.x,
+                      (screen_pos.y - view_h / 2.0f) / zoom + center.y};
+}
+
+GPU_Camera Camera::to_gpu_camera() const
+{
+    // Without a centered origin SDL_gpu maps world to screen as
+    // `world * zoom - camera`, so the camera sits at the scaled top-left
+    // corner of the view.
+    GPU_Camera gpu_camera = GPU_GetDefaultCamera();
+    gpu_camera.use_centered_origin = GPU_FALSE;
+    gpu_camera.zoom_x = zoom;
+    gpu_camera.zoom_y = zoom;
+    gpu_camera.x = center.x * zoom - view_w / 2.0f;
+    gpu_camera.y = center.y * zoom - view_h / 2.0f;
+    return gpu_camera;
+}
+
+} // namespace LCode
@@ -0,0 +1,181 @@
+#include "CullGrid.hpp"
+#include "LException.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+static bool rects_overlap(const SDL_FRect & a, const SDL_FRect & b)
+{
+    return a.x <= b.x + b.w && b.x <= a.x + a.w
+           && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+CullGrid::CullGrid(float bucket_size)
+: cell_size{bucket_size}, inv_cell_size{1.0f}, columns{1}, rows{1},
+  max_column{0.0f}, max_row{0.0f},
+  buckets(1), large{}, next_order{0}, count{0}
+{
+    if (!(bucket_size > 0.0f))
+    {
+        throw LException{"CullGrid bucket size must be positive!"};
+    }
+    inv_cell_size = 1.0f / bucket_size;
+}
+
+CullGrid::~CullGrid() = default;
+
+void CullGrid::resize(float width, float height)
+{
+    int new_columns = std::max(1, static_cast<int>(std::ceil(width * inv_cell_size)));
+    int new_rows = std::max(1, static_cast<int>(std::ceil(height * inv_cell_size)));
+    if (new_columns == columns && new_rows == rows)
+    {
+        return;
+    }
+    // gather everything first, the old buckets are gone once resized
+    std::vector<LEntity *> entities;
+    entities.reserve(count);
+    for (const std::vector<LEntity *> & bucket : buckets)
+    {
+        entities.insert(entities.end(), bucket.begin(), bucket.end());
+    }
+    entities.insert(entities.end(), large.begin(), large.end());
+
+    columns = new_columns;
+    rows = new_rows;
+    max_column = static_cast<float>(columns - 1);
+    max_row = static_cast<float>(rows - 1);
+    buckets.assign(static_cast<size_t>(columns) * static_cast<size_t>(rows),
+                   std::vector<LEntity *>{});
+    large.clear();
+    for (LEntity * entity : entities)
+    {
+        place(entity, classify(*entity));
+    }
+}
+
+void CullGrid::insert(LEntity * entity)
+{
+    entity->draw_order = next_order++;
+    place(entity, classify(*entity));
+    ++count;
+}
+
+void CullGrid::remove(LEntity * entity)
+{
+    if (entity->cull_bucket == NOT_ADDED)
+    {
+        return;
+    }
+    unplace(entity);
+    entity->cull_bucket = NOT_ADDED;
+    --count;
+}
+
+void CullGrid::clear()
+{
+    for (std::vector<LEntity *> & bucket : buckets)
+    {
+        bucket.clear();
+    }
+    large.clear();
+    count = 0;
+}
+
+void CullGrid::find_visible(const SDL_FRect & view, std::vector<LEntity *> & out) const
+{
+    out.clear();
+    auto add_if_visible = [&out, &view](LEntity * entity)
+    {
+        if (!entity->deleted && rects_overlap(entity->get_bounds(), view))
+        {
+            out.push_back(entity);
+        }
+    };
+    // an entity in a bucket reaches at most one bucket past its position
+    auto bucket_range = [this](float low, float high, int last)
+    {
+        int first = static_cast<int>(std::clamp((low - cell_size) * inv_cell_size,
+                                                0.0f, static_cast<float>(last)));
+        int end = static_cast<int>(std::clamp((high + cell_size) * inv_cell_size,
+                                              0.0f, static_cast<float>(last)));
+        return std::pair<int, int>{first, end};
+    };
+    auto [first_col, last_col] = bucket_range(view.x, view.x + view.w, columns - 1);
+    auto [first_row, last_row] = bucket_range(view.y, view.y + view.h, rows - 1);
+    for (int row = first_row; row <= last_row; ++row)
+    {
+        for (int col = first_col; col <= last_col; ++col)
+        {
+            for (LEntity * entity : buckets[static_cast<size_t>(row * columns + col)])
+            {
+                add_if_visible(entity);
+            }
+        }
+    }
+    for (LEntity * entity : large)
+    {
+        add_if_visible(entity);
+    }
+    // buckets hold their entities in no order, only what's found is sorted
+    std::sort(out.begin(), out.end(), [](const LEntity * a, const LEntity * b)
+    {
+        return a->draw_order < b->draw_order;
+    });
+}
+
+size_t CullGrid::size() const
+{
+    return count;
+}
+
+
+// ---- PRIVATE METHODS ----
+
+std::int32_t CullGrid::classify(const LEntity & entity) const
+{
+    SDL_FRect bounds = entity.get_bounds();
+    if (bounds.w > cell_size || bounds.h > cell_size)
+    {
+        return LARGE;
+    }
+    return bucket_of(entity.pos.x, entity.pos.y);
+}
+
+std::vector<LEntity *> & CullGrid::list_of(std::int32_t bucket)
+{
+    return bucket == LARGE? large : buckets[static_cast<size_t>(bucket)];
+}
+
+void CullGrid::move(LEntity * entity, std::int32_t bucket)
+{
+    unplace(entity);
+    place(entity, bucket);
+}
+
+void CullGrid::place(LEntity * entity, std::int32_t bucket)
+{
+    std::vector<LEntity *> & list = list_of(bucket);
+    entity->cull_bucket = bucket;
+    entity->cull_slot = static_cast<std::uint32_t>(list.size());
+    list.push_back(entity);
+}
+
+void CullGrid::unplace(LEntity * entity)
+{
+    // swap with the last entity of the bucket and pop
+    std::vector<LEntity *> & list = list_of(entity->cull_bucket);
+    LEntity * last = list.back();
+    list[entity->cull_slot] = last;
+    last->cull_slot = entity->cull_slot;
+    list.pop_back();
+}
+
+} // namespace LCode
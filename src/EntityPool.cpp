@@ -0,0 +1,178 @@
+#include "EntityPool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace LCode
+{
+
+// readable name of a type for the stats (mangled when the ABI can't demangle)
+static std::string type_display_name(const std::type_info & type)
+{
+    #ifdef __GNUG__
+    int status = 0;
+    char * demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr)
+    {
+        std::string name{demangled};
+        std::free(demangled);
+        return name;
+    }
+    #endif
+    return type.name();
+}
+
+// ---- EntitySlab ----
+
+EntitySlab::EntitySlab(std::string type_name, size_t block_size, size_t block_alignment,
+                       size_t chunk_blocks)
+: chunks{}, free_list{nullptr}, stats{},
+  alignment{std::max(block_alignment, alignof(FreeBlock))},
+  blocks_per_chunk{std::max<size_t>(chunk_blocks, 1)}
+{
+    // every block must fit a free list node and keep the next block aligned
+    size_t size = std::max(block_size, sizeof(FreeBlock));
+    stats.type_name = std::move(type_name);
+    stats.block_size = (size + alignment - 1) / alignment * alignment;
+}
+
+EntitySlab::~EntitySlab()
+{
+    for (void * chunk : chunks)
+    {
+        ::operator delete(chunk, std::align_val_t{alignment});
+    }
+    chunks.clear();
+    free_list = nullptr;
+}
+
+void * EntitySlab::allocate()
+{
+    if (free_list == nullptr)
+    {
+        grow();
+    }
+    FreeBlock * block = free_list;
+    free_list = block->next;
+
+    ++stats.in_use;
+    stats.high_water = std::max(stats.high_water, stats.in_use);
+    return block;
+}
+
+void EntitySlab::release(void * block)
+{
+    FreeBlock * freed = static_cast<FreeBlock *>(block);
+    freed->next = free_list;
+    free_list = freed;
+    --stats.in_use;
+}
+
+const SlabStats & EntitySlab::get_stats() const
+{
+    return stats;
+}
+
+void EntitySlab::grow()
+{
+    std::byte * chunk = static_cast<std::byte *>(
+            ::operator new(stats.block_size * blocks_per_chunk, std::align_val_t{alignment}));
+    chunks.push_back(chunk);
+
+    // push in reverse so blocks are handed out in address order
+    for (size_t i = blocks_per_chunk; i > 0; --i)
+    {
+        FreeBlock * block = reinterpret_cast<FreeBlock *>(chunk + (i - 1) * stats.block_size);
+        block->next = free_list;
+        free_list = block;
+    }
+    stats.capacity += blocks_per_chunk;
+}
+
+
+// ---- EntityPool ----
+
+EntityPool::EntityPool()
+: slabs{}
+{ }
+
+void EntityPool::destroy(LEntity * entity)
+{
+    if (entity == nullptr)
+    {
+        return;
+    }
+    EntitySlab * slab = entity->slab;
+    if (slab != nullptr)
+    {
+        entity->~LEntity();
+        slab->release(entity);
+    }
+    else
+    {
+        delete entity;
+    }
+}
+
+std::vector<SlabStats> EntityPool::get_stats() const
+{
+    std::vector<SlabStats> all_stats;
+    all_stats.reserve(slabs.size());
+    for (const auto & [type, slab] : slabs)
+    {
+        all_stats.push_back(slab->get_stats());
+    }
+    return all_stats;
+}
+
+SlabStats EntityPool::get_total_stats() const
+{
+    SlabStats total;
+    total.type_name = "total";
+    for (const auto & [type, slab] : slabs)
+    {
+        const SlabStats & stats = slab->get_stats();
+        total.block_size += stats.block_size * stats.capacity;
+        total.in_use += stats.in_use;
+        total.capacity += stats.capacity;
+        total.high_water += stats.high_water;
+    }
+    return total;
+}
+
+EntitySlab & EntityPool::get_slab(const std::type_info & type, size_t size, size_t align)
+{
+    std::unique_ptr<EntitySlab> & slab = slabs[std::type_index{type}];
+    if (slab == nullptr)
+    {
+        slab = std::make_unique<EntitySlab>(type_display_name(type), size, align);
+    }
+    return *slab;
+}
+
+
+std::ostream & operator << (std::ostream & os, const SlabStats & stats)
+{
+    return os << stats.type_name << ": " << stats.in_use << " / " << stats.capacity
+              << " blocks in use (high water " << stats.high_water << ", "
+              << stats.block_size << " B/block)";
+}
+
+std::ostream & operator << (std::ostream & os, const EntityPool & pool)
+{
+    for (const SlabStats & stats : pool.get_stats())
+    {
+        os << "pool " << stats << "\n";
+    }
+    return os;
+}
+
+} // namespace LCode
@@ -0,0 +1,137 @@
+#include "FramePacer.hpp"
+#include "LTimer.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <iostream>
+#include <cstddef>
+#include <cmath>
+
+namespace LCode
+{
+
+// weight of the newest frame in `recent_jitter_ms`
+static const double RECENT_WEIGHT = 1.0 / 60.0;
+
+
+double PacingStats::get_mean_frame_ms() const
+{
+    return frames > 0? total_frame_ms / static_cast<double>(frames) : 0.0;
+}
+
+double PacingStats::get_mean_jitter_ms() const
+{
+    return frames > 0? total_jitter_ms / static_cast<double>(frames) : 0.0;
+}
+
+std::ostream & operator << (std::ostream & os, const PacingStats & stats)
+{
+    os << "paced frames:  " << stats.frames << "\n"
+       << "target frame:  ";
+    if (stats.target_ms > 0.0)
+    {
+        os << stats.target_ms << " ms\n";
+    }
+    else
+    {
+        os << "unlimited\n";
+    }
+    return os << "mean frame:    " << stats.get_mean_frame_ms() << " ms\n"
+              << "jitter:        " << stats.get_mean_jitter_ms() << " ms mean, "
+                                   << stats.max_jitter_ms << " ms max\n"
+              << "waiting:       " << stats.slept_ms << " ms asleep, "
+                                   << stats.spun_ms << " ms spinning\n";
+}
+
+
+FramePacer::FramePacer()
+: target_ms{0}, next_frame_ms{0}, last_frame_ms{0},
+  spin_margin_ms{MIN_SPIN_MARGIN_MS}, stats{}
+{ }
+
+void FramePacer::set_target_fps(double fps)
+{
+    set_target_frame_ms(fps > 0.0? 1000.0 / fps : 0.0);
+}
+
+void FramePacer::set_target_frame_ms(double frame_ms)
+{
+    target_ms = std::max(frame_ms, 0.0);
+    stats.target_ms = target_ms;
+    // pace the next frame from the last one at the new rate
+    next_frame_ms = last_frame_ms + target_ms;
+}
+
+double FramePacer::get_target_frame_ms() const
+{
+    return target_ms;
+}
+
+void FramePacer::reset(double now_ms)
+{
+    last_frame_ms = now_ms;
+    next_frame_ms = now_ms + target_ms;
+    stats = PacingStats{};
+    stats.target_ms = target_ms;
+}
+
+void FramePacer::wait(LTimer & timer)
+{
+    double now = timer.get_ms();
+    if (target_ms > 0.0)
+    {
+        // sleep through most of the wait, SDL_Delay has 1 ms granularity
+        // at best and may oversleep by more
+        while (next_frame_ms - now > spin_margin_ms)
+        {
+            Uint32 sleep_ms = static_cast<Uint32>(next_frame_ms - now - spin_margin_ms);
+            if (sleep_ms == 0)
+            {
+                break;
+            }
+            double before = now;
+            SDL_Delay(sleep_ms);
+            now = timer.get_ms();
+            stats.slept_ms += now - before;
+
+            double overslept = now - before - static_cast<double>(sleep_ms);
+            if (overslept > spin_margin_ms)
+            {
+                spin_margin_ms = std::min(overslept, MAX_SPIN_MARGIN_MS);
+            }
+        }
+        // then spin until the deadline, which is far more precise
+        double spin_start = now;
+        while (now < next_frame_ms)
+        {
+            now = timer.get_ms();
+        }
+        stats.spun_ms += now - spin_start;
+        spin_margin_ms = std::max(spin_margin_ms * 0.99, MIN_SPIN_MARGIN_MS);
+
+        // schedule from the deadline rather than from now so rounding
+        // doesn't drift, unless a slow frame already missed the next one
+        next_frame_ms += target_ms;
+        if (next_frame_ms <= now)
+        {
+            next_frame_ms = now + target_ms;
+        }
+    }
+
+    double frame_ms = now - last_frame_ms;
+    last_frame_ms = now;
+    double jitter_ms = target_ms > 0.0? std::abs(frame_ms - target_ms) : 0.0;
+    ++stats.frames;
+    stats.total_frame_ms += frame_ms;
+    stats.total_jitter_ms += jitter_ms;
+    stats.max_jitter_ms = std::max(stats.max_jitter_ms, jitter_ms);
+    stats.recent_jitter_ms += (jitter_ms - stats.recent_jitter_ms) * RECENT_WEIGHT;
+}
+
+const PacingStats & FramePacer::get_stats() const
+{
+    return stats;
+}
+
+} // namespace LCode
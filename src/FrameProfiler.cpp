@@ -0,0 +1,168 @@
+#include "FrameProfiler.hpp"
+
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace LCode
+{
+
+const char * to_string(FramePhase phase)
+{
+    switch (phase)
+    {
+    case FramePhase::EVENTS:            return "events";
+    case FramePhase::SYSTEM_UPDATE:     return "system_update";
+    case FramePhase::UPDATE:            return "update";
+    case FramePhase::UPDATE_ENTITIES:   return "update_entities";
+    case FramePhase::DRAW:              return "draw";
+    case FramePhase::DRAW_ENTITIES:     return "draw_entities";
+    case FramePhase::FLIP:              return "flip";
+    case FramePhase::PACING:            return "pacing";
+    case FramePhase::FRAME:             return "frame";
+    case FramePhase::COUNT:             break;
+    }
+    return "unknown";
+}
+
+
+FrameProfiler::Scope::Scope(FrameProfiler & frame_profiler, FramePhase timed_phase)
+: profiler{frame_profiler}, phase{timed_phase},
+  start{frame_profiler.enabled? SDL_GetPerformanceCounter() : 0}
+{ }
+
+FrameProfiler::Scope::~Scope()
+{
+    if (profiler.enabled)
+    {
+        Uint64 ticks = SDL_GetPerformanceCounter() - start;
+        profiler.add(phase, static_cast<double>(ticks) * 1000.0
+                            / static_cast<double>(SDL_GetPerformanceFrequency()));
+    }
+}
+
+
+FrameProfiler::FrameProfiler(size_t capacity)
+: frames(std::max(capacity, size_t{1})), next_frame{0}, recorded{0}, total_frames{0},
+  last_frame_end{SDL_GetPerformanceCounter()}, current{}, enabled{true}, sorted{}
+{ }
+
+void FrameProfiler::set_enabled(bool enable)
+{
+    enabled = enable;
+    current.fill(0.0);
+}
+
+bool FrameProfiler::is_enabled() const
+{
+    return enabled;
+}
+
+void FrameProfiler::add(FramePhase phase, double ms)
+{
+    current[static_cast<size_t>(phase)] += ms;
+}
+
+void FrameProfiler::end_frame()
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (!enabled)
+    {
+        last_frame_end = now;
+        return;
+    }
+    current[static_cast<size_t>(FramePhase::FRAME)] =
+            static_cast<double>(now - last_frame_end) * 1000.0
+            / static_cast<double>(SDL_GetPerformanceFrequency());
+    last_frame_end = now;
+    frames[next_frame] = current;
+    next_frame = (next_frame + 1) % frames.size();
+    recorded = std::min(recorded + 1, frames.size());
+    ++total_frames;
+    current.fill(0.0);
+}
+
+void FrameProfiler::clear()
+{
+    next_frame = 0;
+    recorded = 0;
+    total_frames = 0;
+    last_frame_end = SDL_GetPerformanceCounter();
+    current.fill(0.0);
+}
+
+size_t FrameProfiler::get_recorded_frames() const
+{
+    return recorded;
+}
+
+PhaseSummary FrameProfiler::summarize(FramePhase phase)
+{
+    PhaseSummary summary;
+    if (recorded == 0)
+    {
+        return summary;
+    }
+    size_t column = static_cast<size_t>(phase);
+    sorted.clear();
+    for (size_t age = 0; age < recorded; ++age)
+    {
+        sorted.push_back(get_frame(age)[column]);
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    // nearest-rank percentile
+    auto percentile = [this](double p)
+    {
+        size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[rank];
+    };
+    summary.p50 = percentile(0.50);
+    summary.p95 = percentile(0.95);
+    summary.p99 = percentile(0.99);
+    summary.max = sorted.back();
+    return summary;
+}
+
+bool FrameProfiler::write_csv(const std::string & path) const
+{
+    std::ofstream file{path};
+    if (!file)
+    {
+        std::cerr << "Unable to open \"" << path << "\" to write the frame profile!\n";
+        return false;
+    }
+
+    file << "frame";
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        file << ',' << to_string(static_cast<FramePhase>(phase)) << "_ms";
+    }
+    file << '\n';
+
+    // oldest frame first, numbered from the start of the run
+    size_t first_frame = total_frames - recorded;
+    for (size_t age = recorded; age > 0; --age)
+    {
+        file << first_frame + recorded - age;
+        for (double ms : get_frame(age - 1))
+        {
+            file << ',' << ms;
+        }
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+const FrameProfiler::FrameTimes & FrameProfiler::get_frame(size_t age) const
+{
+    // age 0 is the newest finished frame
+    return frames[(next_frame + frames.size() - 1 - age) % frames.size()];
+}
+
+} // namespace LCode
@@ -1,49 +1,419 @@
 #include "Game.hpp"
 
 #include "LException.hpp"
+#include "Snapshot.hpp"
 #include "entities/Cell.hpp"
 #include "random.hpp"
 #include "lilyutils.hpp"
+#include "LGlyphAtlas.hpp"
+#include "TextureCache.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <iterator>
 #include <string>
+#include <vector>
+#include <cmath>
 #include <cstdlib>
 
 namespace LCode
 {
 
 // constructor / initialization
-Game::Game()
-: SDLBaseGame(SCREEN_WIDTH, SCREEN_HEIGHT, FONT_SIZE),
-  fps_avg_texture{}, fps_cur_texture{}, load_time_texture{},
-  press_spacebar_texture{}, press_a_texture{},
-  entity_count_texture{},
-  paused{true},
-  space_pressed{false},
-  time_text_avg{}, time_text_cur{}
+Game::Game(const GameOptions & options)
+: SDLBaseGame(SCREEN_WIDTH, SCREEN_HEIGHT, FONT_SIZE, options.headless),
+  load_time_texture{},
+  press_spacebar_texture{}, press_a_texture{}, press_s_texture{},
+  press_r_texture{}, press_p_texture{}, press_c_texture{}, press_view_texture{},
+  press_snapshot_texture{}, press_n_texture{},
+  fps_avg_text{TEXT_COLOR, FPS_REFRESH_MS}, fps_cur_text{TEXT_COLOR, FPS_REFRESH_MS},
+  entity_count_text{TEXT_COLOR, COUNT_REFRESH_MS},
+  batch_stats_text{TEXT_COLOR, FPS_REFRESH_MS}, view_text{TEXT_COLOR, FPS_REFRESH_MS},
+  lod_text{TEXT_COLOR, FPS_REFRESH_MS}, nutrients_text{TEXT_COLOR, FPS_REFRESH_MS},
+  swarm{nullptr}, swarm_simd{true},
+  collisions{options.collisions}, cell_grid{2.0f * Cell::MAX_RADIUS},
+  grid_cells{}, grid_x{}, grid_y{}, cell_overlaps{0},
+  nutrients{}, nutrients_enabled{options.nutrients},
+  telemetry_swarm{nullptr}, telemetry_swarm_cells{0}, telemetry_swarm_died{0},
+  cell_count{0}, cell_life{0.0},
+  profile_lines{}, profile_updated_ms{-1.0}, show_profile{false},
+  paused{options.start_paused.value_or(!options.headless)},
+  space_pressed{false}
 {
-    game_objects_init();
+    set_update_threads(options.update_threads);
+    set_tick_rate(options.tick_rate);
+    set_max_ticks_per_frame(options.max_ticks_per_frame);
+    if (options.target_fps)
+    {
+        get_frame_pacer().set_target_fps(*options.target_fps);
+    }
+    else
+    {
+        get_frame_pacer().set_target_frame_ms(SCREEN_TICKS_PER_FRAME);
+    }
+    set_vsync(options.vsync);
+    set_world_size(options.world_width, options.world_height);
+    Cell::set_render_mode(options.render_mode);
+    Cell::set_lod_thresholds(options.lod);
+    if (options.seed)
+    {
+        set_rand_seed(*options.seed);
+    }
+    game_objects_init(options);
+    mark_load_stage("game objects");
 
     load_timer.pause();
     double load_time_ms = load_timer.get_ms();
+    std::string load_time_text = "time to load: " + round_to(load_time_ms, 0) + " ms ("
+                                 + get_load_breakdown() + ")";
+    std::cout << load_time_text << "\n";
+    if (!is_headless())
+    {
+        load_time_texture.load_text(load_time_text, TEXT_COLOR);
+    }
+}
 
-    std::stringstream load_time_text;
-    load_time_text << "time to load: " << round_to(load_time_ms, 0) << " ms";
-    load_time_texture.load_text(load_time_text.str(), TEXT_COLOR);
+Game::~Game()
+{
+    // the sprite cache holds a GPU image, free it before SDLBaseGame quits SDL_gpu
+    CellSpriteCache::free();
 }
 
-void Game::game_objects_init()
+void Game::game_objects_init(const GameOptions & options)
 {
-    press_spacebar_texture.load_text("Spacebar: pause/unpause", TEXT_COLOR);
-    press_a_texture.load_text("A: Add a cell", TEXT_COLOR);
+    if (!is_headless())
+    {
+        press_spacebar_texture.load_text("Spacebar: pause/unpause", TEXT_COLOR);
+        press_a_texture.load_text("A: Add a cell", TEXT_COLOR);
+        press_s_texture.load_text("S: Add 1000 swarm cells", TEXT_COLOR);
+        press_r_texture.load_text("R: Switch geometry/sprite cells", TEXT_COLOR);
+        press_p_texture.load_text("P: Show/hide frame profile", TEXT_COLOR);
+        press_c_texture.load_text("C: Toggle cell collisions", TEXT_COLOR);
+        press_view_texture.load_text("Arrows, +/-, wheel: Move view, Home: Whole world",
+                                     TEXT_COLOR);
+        press_snapshot_texture.load_text("F5: Save snapshot, F9: Load it", TEXT_COLOR);
+        press_n_texture.load_text("N: Toggle nutrient field", TEXT_COLOR);
+    }
 
+    if (!options.snapshot.empty())
+    {
+        load_snapshot(options.snapshot);
+        return;
+    }
     // add game entities to SDLBaseGame entity handler
-    add_entity(new Cell{SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f});
+    if (options.cells > 0)
+    {
+        spawn_cell(static_cast<float>(get_world_rect().w) / 2.0f,
+                   static_cast<float>(get_world_rect().h) / 2.0f);
+    }
+    for (size_t i = 1; i < options.cells; ++i)
+    {
+        spawn_cell();
+    }
+    if (options.swarm_cells > 0)
+    {
+        get_swarm().add_random_cells(options.swarm_cells);
+    }
+}
+
+size_t Game::get_swarm_size() const
+{
+    return swarm != nullptr? swarm->size() : 0;
+}
+
+void Game::set_swarm_simd(bool enabled)
+{
+    swarm_simd = enabled;
+    if (swarm != nullptr)
+    {
+        swarm->set_simd(enabled);
+    }
+}
+
+bool Game::is_paused() const
+{
+    return paused;
+}
+
+void Game::set_collisions(bool enabled)
+{
+    collisions = enabled;
+    cell_overlaps = 0;
+    if (swarm != nullptr)
+    {
+        swarm->set_collisions(enabled);
+    }
+}
+
+bool Game::has_collisions() const
+{
+    return collisions;
+}
+
+void Game::set_nutrients(bool enabled)
+{
+    nutrients_enabled = enabled;
+}
+
+bool Game::has_nutrients() const
+{
+    return nutrients_enabled;
+}
+
+NutrientField & Game::get_nutrients()
+{
+    return nutrients;
+}
+
+size_t Game::get_overlaps() const
+{
+    return cell_overlaps + (swarm != nullptr? swarm->get_overlaps() : 0);
+}
+
+size_t Game::save_snapshot(const std::string & path) const
+{
+    std::vector<CellRecord> records;
+    for (const LEntity * entity : get_entities())
+    {
+        const Cell * cell = dynamic_cast<const Cell *>(entity);
+        if (cell != nullptr && !cell->is_deleted())
+        {
+            records.push_back(cell->to_record());
+        }
+    }
+
+    SnapshotHeader header;
+    if (!is_world_following_window())
+    {
+        header.world_width = get_world_rect().w;
+        header.world_height = get_world_rect().h;
+    }
+    header.collisions = collisions;
+    header.nutrients = nutrients_enabled;
+    header.seed = get_rand_seed();
+    RandomEngine::State rand_state = get_rand_engine().get_state();
+    std::copy(rand_state.begin(), rand_state.end(), header.rand_state);
+    header.cells = records.size();
+    header.swarm_cells = get_swarm_size();
+
+    SnapshotWriter writer{path, header};
+    writer.write_array(records.data(), records.size());
+    if (swarm != nullptr)
+    {
+        swarm->save_snapshot(writer);
+    }
+    writer.finish();
+    return records.size() + get_swarm_size();
+}
+
+void Game::load_snapshot(const std::string & path)
+{
+    // the reader checks the whole file is there before anything is replaced
+    SnapshotReader reader{path};
+    const SnapshotHeader & header = reader.get_header();
+    std::vector<CellRecord> records(static_cast<size_t>(header.cells));
+    reader.read_array(records.data(), records.size());
+
+    for (LEntity * entity : get_entities())
+    {
+        delete_entity(entity);
+    }
+    swarm = nullptr;
+    // the cells updated so far are all gone
+    take_update_tally();
+    cell_count = 0;
+    cell_life = 0.0;
+    set_world_size(header.world_width, header.world_height);
+    set_collisions(header.collisions != 0);
+    set_nutrients(header.nutrients != 0);
+    // snapshots don't hold the field, it starts full like in a new game
+    // (a field of another size is refilled when it's resized anyway)
+    nutrients.fill(nutrients.get_params().capacity);
+    for (const CellRecord & record : records)
+    {
+        spawn_cell(record);
+    }
+    if (header.swarm_cells > 0)
+    {
+        get_swarm().load_snapshot(reader, static_cast<size_t>(header.swarm_cells));
+    }
+
+    set_rand_seed(header.seed);
+    RandomEngine::State rand_state{};
+    std::copy(std::begin(header.rand_state), std::end(header.rand_state), rand_state.begin());
+    get_rand_engine().set_state(rand_state);
+}
+
+void Game::set_telemetry(TelemetryWriter * writer)
+{
+    SDLBaseGame::set_telemetry(writer);
+    telemetry_swarm = swarm;
+    telemetry_swarm_cells = get_swarm_size();
+    telemetry_swarm_died = swarm != nullptr? swarm->get_died() : 0;
+}
+
+void Game::fill_telemetry(TelemetryRecord & record)
+{
+    if (swarm != telemetry_swarm)
+    {
+        // a new swarm (or none), the old one's cells went with it
+        record.deaths += telemetry_swarm_cells;
+        telemetry_swarm = swarm;
+        telemetry_swarm_cells = 0;
+        telemetry_swarm_died = 0;
+    }
+    size_t swarm_cells = get_swarm_size();
+    std::uint64_t swarm_died = swarm != nullptr? swarm->get_died() : 0;
+    std::uint64_t died = swarm_died - telemetry_swarm_died;
+    record.deaths += died;
+    record.births += swarm_cells + died - telemetry_swarm_cells;
+    telemetry_swarm_cells = swarm_cells;
+    telemetry_swarm_died = swarm_died;
+
+    UpdateTally tally = take_update_tally();
+    cell_count -= static_cast<size_t>(tally.cell_deaths);
+    cell_life += tally.life_change;
+    double total_life = cell_life + (swarm != nullptr? swarm->get_total_life() : 0.0);
+    record.cells = swarm_cells + cell_count;
+    record.mean_life = record.cells > 0? total_life / static_cast<double>(record.cells) : 0.0;
+}
+
+void Game::fill_frame_context(FrameContext & context)
+{
+    if (nutrients_enabled)
+    {
+        // sized before any cell samples it, a new size refills it
+        nutrients.resize(context.world.w, context.world.h);
+        context.nutrients = &nutrients;
+        count_nutrient_demand();
+    }
+    else
+    {
+        context.nutrients = nullptr;
+    }
+}
+
+void Game::count_nutrient_demand()
+{
+    // counted where the cells feed from, before they move
+    nutrients.clear_demand();
+    for (const LEntity * entity : get_entities())
+    {
+        const Cell * cell = dynamic_cast<const Cell *>(entity);
+        if (cell != nullptr && !cell->is_deleted())
+        {
+            nutrients.add_demand(cell->get_pos().x, cell->get_pos().y);
+        }
+    }
+    if (swarm != nullptr)
+    {
+        swarm->add_demand_to(nutrients);
+    }
+}
+
+void Game::step_nutrients()
+{
+    // what the cells ate this tick comes out of the grid cells they fed from
+    nutrients.step(get_frame_context().delta_ms, get_thread_pool());
+}
+
+CellSwarm & Game::get_swarm()
+{
+    if (swarm == nullptr)
+    {
+        swarm = spawn<CellSwarm>();
+        swarm->set_simd(swarm_simd);
+        swarm->set_collisions(collisions);
+    }
+    return *swarm;
+}
+
+void Game::resolve_overlaps()
+{
+    grid_cells.clear();
+    grid_x.clear();
+    grid_y.clear();
+    for (LEntity * entity : get_entities())
+    {
+        Cell * cell = dynamic_cast<Cell *>(entity);
+        if (cell != nullptr && !cell->is_deleted())
+        {
+            grid_cells.push_back(cell);
+            grid_x.push_back(cell->get_pos().x);
+            grid_y.push_back(cell->get_pos().y);
+        }
+    }
+    cell_grid.build(grid_x.data(), grid_y.data(), grid_cells.size(),
+                    static_cast<float>(get_world_rect().w),
+                    static_cast<float>(get_world_rect().h));
+
+    cell_overlaps = 0;
+    cell_grid.for_each_pair([this](size_t a, size_t b)
+    {
+        if (grid_cells[a]->collide(*grid_cells[b]))
+        {
+            ++cell_overlaps;
+            entity_moved(grid_cells[a]);
+            entity_moved(grid_cells[b]);
+        }
+    });
+}
+
+void Game::move_camera()
+{
+    int dx = is_key_down(SDL_SCANCODE_RIGHT) - is_key_down(SDL_SCANCODE_LEFT);
+    int dy = is_key_down(SDL_SCANCODE_DOWN) - is_key_down(SDL_SCANCODE_UP);
+    if (dx != 0 || dy != 0)
+    {
+        // the same speed on screen at any zoom
+        float step = static_cast<float>(CAMERA_PAN_SPEED * delta / 1000.0);
+        get_camera().pan(static_cast<float>(dx) * step, static_cast<float>(dy) * step);
+        get_camera().clamp_to(get_world_rect());
+    }
+}
+
+void Game::update_profile_lines()
+{
+    FrameProfiler & frame_profiler = get_profiler();
+    // the lines keep their storage, so rebuilding them doesn't allocate
+    profile_lines.resize(FrameProfiler::PHASE_COUNT + 1);
+    TextBuffer<HUD_TEXT_CAPACITY> line;
+    line.append("Last ").append(frame_profiler.get_recorded_frames())
+        .append(" frames (ms): p50 / p95 / p99 / max");
+    profile_lines[0].assign(line.view());
+    for (size_t i = 0; i < FrameProfiler::PHASE_COUNT; ++i)
+    {
+        FramePhase phase = static_cast<FramePhase>(i);
+        PhaseSummary summary = frame_profiler.summarize(phase);
+        line.clear();
+        line.append(to_string(phase)).append(": ")
+            .append(summary.p50, 2).append(" / ")
+            .append(summary.p95, 2).append(" / ")
+            .append(summary.p99, 2).append(" / ")
+            .append(summary.max, 2);
+        profile_lines[i + 1].assign(line.view());
+    }
+}
+
+void Game::draw_profile()
+{
+    LGlyphAtlas & atlas = LGlyphAtlas::get(font);
+    int width = 0;
+    for (const std::string & line : profile_lines)
+    {
+        width = std::max(width, atlas.get_text_width(line));
+    }
+    float x = static_cast<float>(get_window_rect().w - width - TEXT_PADDING);
+    float y = TEXT_PADDING;
+    for (const std::string & line : profile_lines)
+    {
+        atlas.draw(gpu, line, x, y, TEXT_COLOR);
+        y += static_cast<float>(atlas.get_line_height());
+    }
 }
 
 void Game::handle_event(SDL_Event & e)
@@ -65,20 +435,107 @@ void Game::handle_event(SDL_Event & e)
         }
         case SDL_SCANCODE_A:
         {
-            const Uint8 * keystate = SDL_GetKeyboardState(nullptr);
-            if (keystate[SDL_SCANCODE_LCTRL] &&
-                (!e.key.repeat || keystate[SDL_SCANCODE_LSHIFT]))
+            bool ctrl = is_key_down(SDL_SCANCODE_LCTRL);
+            bool shift = is_key_down(SDL_SCANCODE_LSHIFT);
+            if (ctrl && (!e.key.repeat || shift))
             {
                 std::cout << "Adding 10 cells...\n";
                 for (Uint8 i = 0; i < 10; ++i)
                 {
-                    add_entity(new Cell);
+                    spawn_cell();
                 }
             }
-            else if (!e.key.repeat || keystate[SDL_SCANCODE_LSHIFT])
+            else if (!e.key.repeat || shift)
             {
                 std::cout << "Adding a cell...\n";
-                add_entity(new Cell);
+                spawn_cell();
+            }
+            break;
+        }
+        case SDL_SCANCODE_S:
+        {
+            if (!e.key.repeat || is_key_down(SDL_SCANCODE_LSHIFT))
+            {
+                size_t count = is_key_down(SDL_SCANCODE_LCTRL)? 10'000 : 1'000;
+                std::cout << "Adding " << count << " swarm cells...\n";
+                get_swarm().add_random_cells(count);
+            }
+            break;
+        }
+        case SDL_SCANCODE_R:
+        {
+            if (!e.key.repeat)
+            {
+                Cell::set_render_mode(Cell::get_render_mode() == CellRenderMode::GEOMETRY
+                                      ? CellRenderMode::SPRITES : CellRenderMode::GEOMETRY);
+                std::cout << "Cell render mode: " << to_string(Cell::get_render_mode()) << "\n";
+            }
+            break;
+        }
+        case SDL_SCANCODE_P:
+        {
+            if (!e.key.repeat)
+            {
+                show_profile = !show_profile;
+                profile_updated_ms = -1.0;
+            }
+            break;
+        }
+        case SDL_SCANCODE_C:
+        {
+            if (!e.key.repeat)
+            {
+                set_collisions(!collisions);
+                std::cout << "Cell collisions: " << (collisions? "on" : "off") << "\n";
+            }
+            break;
+        }
+        case SDL_SCANCODE_N:
+        {
+            if (!e.key.repeat)
+            {
+                set_nutrients(!nutrients_enabled);
+                std::cout << "Nutrient field: " << (nutrients_enabled? "on" : "off") << "\n";
+            }
+            break;
+        }
+        case SDL_SCANCODE_EQUALS:
+        case SDL_SCANCODE_MINUS:
+        {
+            float factor = e.key.keysym.scancode == SDL_SCANCODE_EQUALS
+                           ? CAMERA_ZOOM_STEP : 1.0f / CAMERA_ZOOM_STEP;
+            get_camera().zoom_at(factor, static_cast<float>(get_window_rect().w) / 2.0f,
+                                 static_cast<float>(get_window_rect().h) / 2.0f);
+            break;
+        }
+        case SDL_SCANCODE_HOME:
+        {
+            get_camera().fit(get_world_rect());
+            break;
+        }
+        case SDL_SCANCODE_F5:
+        case SDL_SCANCODE_F9:
+        {
+            if (e.key.repeat)
+            {
+                break;
+            }
+            try
+            {
+                if (e.key.keysym.scancode == SDL_SCANCODE_F5)
+                {
+                    size_t saved = save_snapshot(QUICKSAVE_PATH);
+                    std::cout << "Saved " << saved << " cells to " << QUICKSAVE_PATH << "\n";
+                }
+                else
+                {
+                    load_snapshot(QUICKSAVE_PATH);
+                    std::cout << "Loaded " << QUICKSAVE_PATH << "\n";
+                }
+            }
+            catch (const LException & error)
+            {
+                std::cerr << error.what() << "\n";
             }
             break;
         }
@@ -86,49 +543,155 @@ void Game::handle_event(SDL_Event & e)
             break;
         }
     }
+    else if (e.type == SDL_MOUSEWHEEL && e.wheel.y != 0)
+    {
+        // zoom towards the mouse
+        int mouse_x = 0, mouse_y = 0;
+        SDL_GetMouseState(&mouse_x, &mouse_y);
+        get_camera().zoom_at(std::pow(CAMERA_ZOOM_STEP, static_cast<float>(e.wheel.y)),
+                             static_cast<float>(mouse_x), static_cast<float>(mouse_y));
+        get_camera().clamp_to(get_world_rect());
+    }
 }
 
 void Game::update()
 {
-    // Update text
-    time_text_avg.str("");
-    time_text_avg << "Average FPS: " << round_to(avg_fps, 2);
-
-    time_text_cur.str("");
-    time_text_cur << "Current FPS: " << round_to(cur_fps, 1);
-
-
+    // Update HUD text when due (nothing will draw it when headless),
+    // textures are only re-rendered if the text changed
+    if (!is_headless())
+    {
+        double now_ms = fps_timer.get_ms();
+        // HUD lines are built in stack buffers, only changed text is copied out
+        using HudLine = TextBuffer<HUD_TEXT_CAPACITY>;
+        fps_avg_text.update(now_ms, [this]
+        {
+            HudLine text;
+            text.append("Average FPS: ").append(avg_fps, 2);
+            return text;
+        });
+        fps_cur_text.update(now_ms, [this]
+        {
+            const PacingStats & pacing = get_frame_pacer().get_stats();
+            HudLine text;
+            text.append("Current FPS: ").append(cur_fps, 1);
+            if (pacing.target_ms <= 0.0)
+            {
+                text.append(" (unlimited)");
+                return text;
+            }
+            text.append(" (target ").append(1000.0 / pacing.target_ms, 0)
+                .append(", jitter ").append(pacing.recent_jitter_ms, 2).append(" ms)");
+            return text;
+        });
+        entity_count_text.update(now_ms, [this]
+        {
+            HudLine text;
+            text.append("Entities: ").append(get_entities().size())
+                .append(" (swarm cells: ").append(get_swarm_size()).append(")");
+            if (collisions)
+            {
+                text.append(", overlaps: ").append(get_overlaps());
+            }
+            return text;
+        });
+        batch_stats_text.update(now_ms, [this]
+        {
+            const ShapeBatch & batch = get_shape_batch();
+            TextureCacheStats textures = TextureCache::get_stats();
+            HudLine text;
+            text.append("Cells drawn as ").append(to_string(Cell::get_render_mode()))
+                .append(", shape batches: ").append(batch.get_draw_calls())
+                .append(" (").append(batch.get_vertex_count()).append(" vertices)")
+                .append(", textures: ").append(textures.hits).append(" hits / ")
+                .append(textures.misses).append(" misses");
+            return text;
+        });
+        view_text.update(now_ms, [this]
+        {
+            HudLine text;
+            text.append("View: ").append(get_camera().get_zoom(), 2).append("x, drawing ")
+                .append(get_drawn_last_frame()).append(" entities");
+            if (swarm != nullptr)
+            {
+                text.append(" + ").append(swarm->get_drawn()).append(" swarm cells");
+            }
+            return text;
+        });
+        lod_text.update(now_ms, []
+        {
+            const auto & counts = Cell::get_lod_counts();
+            HudLine text;
+            text.append("Cell detail full / reduced / minimal: ")
+                .append(counts[static_cast<size_t>(CellLod::FULL)]).append(" / ")
+                .append(counts[static_cast<size_t>(CellLod::REDUCED)]).append(" / ")
+                .append(counts[static_cast<size_t>(CellLod::MINIMAL)]);
+            return text;
+        });
+        nutrients_text.update(now_ms, [this]
+        {
+            HudLine text;
+            text.append("Nutrients: ");
+            if (!nutrients_enabled)
+            {
+                text.append("off");
+                return text;
+            }
+            text.append("mean ").append(nutrients.get_mean_level(), 2)
+                .append(" over ").append(nutrients.get_columns()).append("x")
+                .append(nutrients.get_rows()).append(" grid");
+            return text;
+        });
+        move_camera();
+        if (show_profile && (profile_updated_ms < 0.0
+                             || now_ms - profile_updated_ms >= FPS_REFRESH_MS))
+        {
+            profile_updated_ms = now_ms;
+            update_profile_lines();
+        }
+    }
 
     // update game entities only if unpaused
     if (!paused)
     {
         update_entities();
+        if (collisions)
+        {
+            resolve_overlaps();
+        }
+        if (nutrients_enabled)
+        {
+            step_nutrients();
+        }
     }
 }
 
 void Game::draw()
 {
-    // Render string text to texture
-    if ( ! fps_avg_texture.load_text(time_text_avg.str(), TEXT_COLOR) )
-    {
-        std::cerr << "Unable to render FPS Texture!\n";
-    }
-
-    if ( ! fps_cur_texture.load_text(time_text_cur.str(), TEXT_COLOR) )
-    {
-        std::cerr << "Unable to render FPS Texture!\n";
-    }
-    entity_count_texture.load_text("Entities: " + std::to_string(get_entities().size()));
-
-    // draw all game entities
+    // draw all game entities, counting the detail cells are drawn at
+    Cell::reset_lod_counts();
     draw_entities();
 
     // Draw text textures
     load_time_texture.render(TEXT_PADDING, TEXT_PADDING);
-    fps_avg_texture.render(TEXT_PADDING, TEXT_PADDING * 2 + FONT_SIZE);
-    fps_cur_texture.render(TEXT_PADDING, TEXT_PADDING * 3 + FONT_SIZE * 2);
-    entity_count_texture.render(TEXT_PADDING, TEXT_PADDING * 4 + FONT_SIZE * 3);
+    fps_avg_text.render(TEXT_PADDING, TEXT_PADDING * 2 + FONT_SIZE);
+    fps_cur_text.render(TEXT_PADDING, TEXT_PADDING * 3 + FONT_SIZE * 2);
+    entity_count_text.render(TEXT_PADDING, TEXT_PADDING * 4 + FONT_SIZE * 3);
     press_a_texture.render(TEXT_PADDING, TEXT_PADDING * 5 + FONT_SIZE * 4);
+    press_s_texture.render(TEXT_PADDING, TEXT_PADDING * 6 + FONT_SIZE * 5);
+    press_r_texture.render(TEXT_PADDING, TEXT_PADDING * 7 + FONT_SIZE * 6);
+    press_p_texture.render(TEXT_PADDING, TEXT_PADDING * 8 + FONT_SIZE * 7);
+    press_c_texture.render(TEXT_PADDING, TEXT_PADDING * 9 + FONT_SIZE * 8);
+    press_view_texture.render(TEXT_PADDING, TEXT_PADDING * 10 + FONT_SIZE * 9);
+    press_snapshot_texture.render(TEXT_PADDING, TEXT_PADDING * 11 + FONT_SIZE * 10);
+    batch_stats_text.render(TEXT_PADDING, TEXT_PADDING * 12 + FONT_SIZE * 11);
+    view_text.render(TEXT_PADDING, TEXT_PADDING * 13 + FONT_SIZE * 12);
+    lod_text.render(TEXT_PADDING, TEXT_PADDING * 14 + FONT_SIZE * 13);
+    press_n_texture.render(TEXT_PADDING, TEXT_PADDING * 15 + FONT_SIZE * 14);
+    nutrients_text.render(TEXT_PADDING, TEXT_PADDING * 16 + FONT_SIZE * 15);
+    if (show_profile)
+    {
+        draw_profile();
+    }
     if (!space_pressed)
     {
         float screen_width = static_cast<float>(get_window_rect().w);
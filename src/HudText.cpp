@@ -0,0 +1,79 @@
+#include "HudText.hpp"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace LCode
+{
+
+HudText::HudText(SDL_Color text_color, double refresh_interval_ms)
+: texture{}, text{}, color{text_color},
+  refresh_ms{refresh_interval_ms}, last_update_ms{-1.0},
+  dirty{false}, reloads{0}
+{ }
+
+bool HudText::is_due(double now_ms) const
+{
+    return last_update_ms < 0.0 || now_ms - last_update_ms >= refresh_ms;
+}
+
+bool HudText::set_text(std::string_view new_text)
+{
+    if (new_text == text)
+    {
+        return false;
+    }
+    text.assign(new_text);
+    dirty = true;
+    return true;
+}
+
+void HudText::set_refresh_interval(double interval_ms)
+{
+    refresh_ms = interval_ms;
+}
+
+void HudText::render(float x, float y)
+{
+    if (dirty)
+    {
+        if (text.empty())
+        {
+            // SDL_ttf can't render an empty string
+            texture.free();
+        }
+        else if ( ! texture.load_text(text, color) )
+        {
+            std::cerr << "Unable to render HUD text \"" << text << "\"!\n";
+        }
+        dirty = false;
+        ++reloads;
+    }
+    if (!text.empty())
+    {
+        texture.render(x, y);
+    }
+}
+
+const std::string & HudText::get_text() const
+{
+    return text;
+}
+
+int HudText::get_width()
+{
+    return texture.get_width();
+}
+
+int HudText::get_height()
+{
+    return texture.get_height();
+}
+
+size_t HudText::get_reload_count() const
+{
+    return reloads;
+}
+
+} // namespace LCode
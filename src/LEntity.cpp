@@ -1,26 +1,75 @@
 #include "LEntity.hpp"
 
 #include "SDLBaseGame.hpp"
+#include "CullGrid.hpp"
+#include "lilyutils.hpp"
+
+#include <cstdint>
 
 namespace LCode
 {
 
 LEntity::LEntity()
-: pos{static_cast<float>(SDLBaseGame::get_instance()->get_window_rect().w) / 2.0f,
-      static_cast<float>(SDLBaseGame::get_instance()->get_window_rect().h) / 2.0f}
+: deleted{false}, slab{nullptr}, cull_bucket{CullGrid::NOT_ADDED}, cull_slot{0},
+  draw_order{0},
+  pos{static_cast<float>(SDLBaseGame::get_instance()->get_world_rect().w) / 2.0f,
+      static_cast<float>(SDLBaseGame::get_instance()->get_world_rect().h) / 2.0f},
+  prev_pos{pos}
 { }
 
 LEntity::LEntity(SDL_FPoint new_pos)
-: pos{new_pos}
+: deleted{false}, slab{nullptr}, cull_bucket{CullGrid::NOT_ADDED}, cull_slot{0},
+  draw_order{0}, pos{new_pos}, prev_pos{new_pos}
 { }
 
 LEntity::LEntity(float x, float y)
-: pos{x, y}
+: deleted{false}, slab{nullptr}, cull_bucket{CullGrid::NOT_ADDED}, cull_slot{0},
+  draw_order{0}, pos{x, y}, prev_pos{x, y}
+{ }
+
+bool LEntity::is_deleted() const
+{
+    return deleted;
+}
+
+const SDL_FPoint & LEntity::get_pos() const
+{
+    return pos;
+}
+
+void LEntity::draw_overlay(GPU_Target *)
 { }
 
+void LEntity::save_previous_state()
+{
+    prev_pos = pos;
+}
+
+std::uint64_t LEntity::get_state_hash() const
+{
+    return hash_combine(hash_combine(0, pos.x), pos.y);
+}
+
+SDL_FRect LEntity::get_bounds() const
+{
+    return SDL_FRect{pos.x, pos.y, 0.0f, 0.0f};
+}
+
+bool LEntity::splits_own_update() const
+{
+    return false;
+}
+
 void LEntity::delete_self()
 {
     SDLBaseGame::get_instance()->delete_entity(this);
 }
 
+SDL_FPoint LEntity::get_draw_pos() const
+{
+    float alpha = static_cast<float>(SDLBaseGame::get_instance()->get_interpolation_alpha());
+    return SDL_FPoint{prev_pos.x + (pos.x - prev_pos.x) * alpha,
+                      prev_pos.y + (pos.y - prev_pos.y) * alpha};
+}
+
 } // namespace LCode
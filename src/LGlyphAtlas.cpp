@@ -0,0 +1,167 @@
+#include "LGlyphAtlas.hpp"
+#include "LException.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace LCode
+{
+// ---- Static initializers ----
+std::unordered_map<TTF_Font *, std::unique_ptr<LGlyphAtlas>> LGlyphAtlas::atlases{};
+
+// width of the atlas image, glyphs wrap onto new rows past this
+static const int ATLAS_WIDTH = 512;
+
+
+LGlyphAtlas::LGlyphAtlas(TTF_Font * font)
+: image{nullptr}, glyphs{}, line_height{0}
+{
+    if (font == nullptr)
+    {
+        throw LException{"Cannot build a glyph atlas without a font!"};
+    }
+
+    // render every glyph in white so any color can be applied when drawing
+    const SDL_Color white{0xFF, 0xFF, 0xFF, 0xFF};
+    std::array<SDL_Surface *, GLYPH_COUNT> surfaces{};
+    for (int i = 0; i < GLYPH_COUNT; ++i)
+    {
+        Uint16 ch = static_cast<Uint16>(FIRST_GLYPH + i);
+        surfaces[i] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (surfaces[i] == nullptr)
+        {
+            for (SDL_Surface * surface : surfaces)
+            {
+                SDL_FreeSurface(surface);
+            }
+            throw LException{"Unable to render glyph '" + std::string(1, static_cast<char>(ch))
+                             + "'! SDL_ttf Error: " + std::string{TTF_GetError()} + '\n'};
+        }
+        line_height = std::max(line_height, surfaces[i]->h);
+    }
+
+    // lay the glyphs out in rows, left to right
+    int x = 0, y = 0;
+    for (int i = 0; i < GLYPH_COUNT; ++i)
+    {
+        if (x + surfaces[i]->w > ATLAS_WIDTH)
+        {
+            x = 0;
+            y += line_height;
+        }
+        glyphs[i] = GPU_Rect{static_cast<float>(x), static_cast<float>(y),
+                             static_cast<float>(surfaces[i]->w),
+                             static_cast<float>(line_height)};
+        x += surfaces[i]->w;
+    }
+
+    SDL_Surface * atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + line_height,
+                                                                 32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas_surface != nullptr)
+    {
+        SDL_FillRect(atlas_surface, nullptr, SDL_MapRGBA(atlas_surface->format, 0xFF, 0xFF, 0xFF, 0x00));
+        for (int i = 0; i < GLYPH_COUNT; ++i)
+        {
+            // copy alpha straight across instead of blending onto the atlas
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_Rect dest{static_cast<int>(glyphs[i].x), static_cast<int>(glyphs[i].y),
+                          surfaces[i]->w, surfaces[i]->h};
+            SDL_BlitSurface(surfaces[i], nullptr, atlas_surface, &dest);
+        }
+        image = GPU_CopyImageFromSurface(atlas_surface);
+        SDL_FreeSurface(atlas_surface);
+    }
+    for (SDL_Surface * surface : surfaces)
+    {
+        SDL_FreeSurface(surface);
+    }
+
+    if (image == nullptr)
+    {
+        throw LException{"Unable to create glyph atlas texture! SDL Error: "
+                         + std::string{SDL_GetError()} + '\n'};
+    }
+    GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
+}
+
+LGlyphAtlas::~LGlyphAtlas()
+{
+    if (image != nullptr)
+    {
+        GPU_FreeImage(image);
+        image = nullptr;
+    }
+}
+
+LGlyphAtlas & LGlyphAtlas::get(TTF_Font * font)
+{
+    std::unique_ptr<LGlyphAtlas> & atlas = atlases[font];
+    if (atlas == nullptr)
+    {
+        atlas = std::make_unique<LGlyphAtlas>(font);
+    }
+    return *atlas;
+}
+
+void LGlyphAtlas::free_all()
+{
+    atlases.clear();
+}
+
+void LGlyphAtlas::draw(GPU_Target * gpu, std::string_view text, float x, float y,
+                       SDL_Color color)
+{
+    // every glyph comes from the same image, so SDL_gpu keeps these
+    // blits in a single batch
+    GPU_SetColor(image, color);
+    for (char c : text)
+    {
+        const GPU_Rect & glyph = get_glyph(c);
+        GPU_Rect src = glyph;
+        GPU_Rect dest{x, y, glyph.w, glyph.h};
+        GPU_BlitRect(image, &src, gpu, &dest);
+        x += glyph.w;
+    }
+}
+
+void LGlyphAtlas::draw_centered(GPU_Target * gpu, std::string_view text, float x, float y,
+                                SDL_Color color)
+{
+    draw(gpu, text,
+         x - static_cast<float>(get_text_width(text)) / 2.0f,
+         y - static_cast<float>(line_height) / 2.0f, color);
+}
+
+int LGlyphAtlas::get_text_width(std::string_view text) const
+{
+    float width = 0;
+    for (char c : text)
+    {
+        width += get_glyph(c).w;
+    }
+    return static_cast<int>(width);
+}
+
+int LGlyphAtlas::get_line_height() const
+{
+    return line_height;
+}
+
+const GPU_Rect & LGlyphAtlas::get_glyph(char c) const
+{
+    // characters outside the atlas are drawn as spaces
+    if (c < FIRST_GLYPH || c > LAST_GLYPH)
+    {
+        c = ' ';
+    }
+    return glyphs[static_cast<size_t>(c - FIRST_GLYPH)];
+}
+
+} // namespace LCode
@@ -1,11 +1,14 @@
 #include "LTexture.hpp"
 #include "LException.hpp"
+#include "TextureCache.hpp"
 
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <iostream>
 
 namespace LCode
@@ -27,29 +30,29 @@ LTexture::LTexture(GPU_Target * gpu_ref)
 { }
 
 LTexture::LTexture(GPU_Target * gpu_ref, TTF_Font * font_ref)
-: image{nullptr},
+: image{},
   color{0xFF, 0xFF, 0xFF, 0xFF},
+  blend_mode{GPU_BLEND_NORMAL},
   width{0}, height{0},
   file_path{""},
   gpu{gpu_ref},
   font{font_ref}
-{
-    set_color(color);
-}
+{ }
 
 
 LTexture::LTexture(const LTexture & other)
-: LTexture()
-{
-    if (other.image != nullptr)
-    {
-        copy(other);
-    }
-}
+: image{other.image},
+  color{other.color},
+  blend_mode{other.blend_mode},
+  width{other.width}, height{other.height},
+  file_path{other.file_path},
+  gpu{other.gpu},
+  font{other.font}
+{ }
 
 LTexture & LTexture::operator = (const LTexture & other)
 {
-    if (this != &other && other.image != nullptr)
+    if (this != &other)
     {
         copy(other);
     }
@@ -58,12 +61,43 @@ LTexture & LTexture::operator = (const LTexture & other)
 
 void LTexture::copy(const LTexture & other)
 {
-    free();
-    load(other.file_path); // sets width, height, file_path as well as load texture
+    // shares the image instead of loading `file_path` again, so text copies too
+    image = other.image;
+    color = other.color;
+    blend_mode = other.blend_mode;
+    width = other.width;
+    height = other.height;
+    file_path = other.file_path;
     gpu = other.gpu;
     font = other.font;
 }
 
+LTexture::LTexture(LTexture && other) noexcept
+: image{std::move(other.image)},
+  color{other.color},
+  blend_mode{other.blend_mode},
+  width{std::exchange(other.width, 0)}, height{std::exchange(other.height, 0)},
+  file_path{std::move(other.file_path)},
+  gpu{other.gpu},
+  font{other.font}
+{ }
+
+LTexture & LTexture::operator = (LTexture && other) noexcept
+{
+    if (this != &other)
+    {
+        image = std::move(other.image);
+        color = other.color;
+        blend_mode = other.blend_mode;
+        width = std::exchange(other.width, 0);
+        height = std::exchange(other.height, 0);
+        file_path = std::move(other.file_path);
+        gpu = other.gpu;
+        font = other.font;
+    }
+    return *this;
+}
+
 LTexture::~LTexture()
 {
     free();
@@ -80,6 +114,11 @@ void LTexture::set_fallback_gpu(GPU_Target * gpu_ref)
     fallback_gpu = gpu_ref;
 }
 
+GPU_Target * LTexture::get_fallback_gpu()
+{
+    return fallback_gpu;
+}
+
 
 #ifdef SDL_TTF_MAJOR_VERSION
 void LTexture::set_font(TTF_Font * font_ref)
@@ -91,6 +130,11 @@ void LTexture::set_fallback_font(TTF_Font * font_ref)
 {
     fallback_font = font_ref;
 }
+
+TTF_Font * LTexture::get_fallback_font()
+{
+    return fallback_font;
+}
 #endif
 
 bool LTexture::load(std::string path)
@@ -98,18 +142,11 @@ bool LTexture::load(std::string path)
     // get rid of preexisting texture
     free();
 
-    image = GPU_LoadImage(path.c_str());
-    if (image == nullptr)
-    {
-        throw LException{"Unable to load image file into surface at \"" + path
-                + "\"! SDL Error: " + std::string{SDL_GetError()} + '\n'};
-    }
-    else
-    {
-        width = image->w;
-        height = image->h;
-        file_path = path;
-    }
+    // throws if the image isn't cached and can't be loaded
+    image = TextureCache::load_image(path);
+    width = image->w;
+    height = image->h;
+    file_path = path;
 
     return image != nullptr;
 }
@@ -120,31 +157,11 @@ bool LTexture::load_text(std::string text, SDL_Color text_color, TTF_Font * font
     // Get rid of preexisting texture
     free();
 
-    // render text to a surface
-    SDL_Surface * text_surface = TTF_RenderText_Solid(get_font(font_override), text.c_str(), text_color);
-    if (text_surface == nullptr)
-    {
-        throw LException{"Unable to render text surface! SDL_TTF Error: "
-                         + std::string{TTF_GetError()} + '\n'};
-    }
-    else
-    {
-        // create texture from surface pixels
-        image = GPU_CopyImageFromSurface(text_surface);
-        if (image == nullptr)
-        {
-            throw LException{"Unable to create texture from rendered text surface! SDL Error: "
-                             + std::string{SDL_GetError()} + '\n'};
-        }
-        else
-        {
-            width = text_surface->w;
-            height = text_surface->h;
-            file_path = "";
-        }
-
-        SDL_FreeSurface(text_surface);
-    }
+    // throws if the text isn't cached and can't be rendered
+    image = TextureCache::load_text(text, get_font(font_override), text_color);
+    width = image->w;
+    height = image->h;
+    file_path = "";
 
     return image != nullptr;
 
@@ -155,8 +172,7 @@ void LTexture::free()
 {
     if (image != nullptr)
     {
-        GPU_FreeImage(image);
-        image = nullptr;
+        image.reset();
         width = 0;
         height = 0;
     }
@@ -173,7 +189,6 @@ void LTexture::set_color(Uint8 red, Uint8 green, Uint8 blue)
 }
 void LTexture::set_color(SDL_Color new_color)
 {
-    GPU_SetColor(image, new_color);
     color = new_color;
 }
 void LTexture::set_alpha(Uint8 alpha)
@@ -181,9 +196,9 @@ void LTexture::set_alpha(Uint8 alpha)
     set_color(color.r, color.g, color.b, alpha);
 }
 
-void LTexture::set_blend_mode(GPU_BlendPresetEnum blend_mode)
+void LTexture::set_blend_mode(GPU_BlendPresetEnum new_blend_mode)
 {
-    GPU_SetBlendMode(image, blend_mode);
+    blend_mode = new_blend_mode;
 }
 
 // Renders texture at specified point, and other optional parameters
@@ -205,9 +220,13 @@ void LTexture::render(GPU_Target * gpu_override, float x, float y, GPU_Rect * cl
         render_rect.h = clip->h;
     }
 
+    // the image is shared, so apply this texture's color and blend mode first
+    GPU_SetColor(image.get(), color);
+    GPU_SetBlendMode(image.get(), blend_mode);
+
     // Render to screen!
     //SDL_RenderCopyEx(get_renderer(renderer_override), texture, clip, &render_quad, angle, center, flip);
-    GPU_BlitRectX(image, clip, get_gpu(gpu_override), &render_rect, angle,
+    GPU_BlitRectX(image.get(), clip, get_gpu(gpu_override), &render_rect, angle,
                     static_cast<float>(center != nullptr? center->x : 0),
                     static_cast<float>(center != nullptr? center->y : 0), flip);
 }
@@ -0,0 +1,231 @@
+#include "NutrientField.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace LCode
+{
+
+#if defined(__AVX__)
+const char * const NutrientField::SIMD_NAME = "AVX";
+#elif defined(__SSE2__)
+const char * const NutrientField::SIMD_NAME = "SSE2";
+#else
+const char * const NutrientField::SIMD_NAME = "scalar";
+#endif
+
+NutrientField::NutrientField(const NutrientParams & field_params)
+: params{field_params}, columns{0}, rows{0},
+  inv_cell_size{1.0f / field_params.cell_size}, max_column{0.0f}, max_row{0.0f},
+  levels{}, next_levels{}, demand{}, use_simd{true}
+{ }
+
+NutrientField::~NutrientField() = default;
+
+void NutrientField::resize(int world_width, int world_height)
+{
+    auto cells_along = [this](int length)
+    {
+        float cells = std::max(static_cast<float>(length), 1.0f) * inv_cell_size;
+        return std::max(static_cast<size_t>(cells + 0.999f), size_t{1});
+    };
+    size_t new_columns = cells_along(world_width);
+    size_t new_rows = cells_along(world_height);
+    if (new_columns == columns && new_rows == rows)
+    {
+        return;
+    }
+    columns = new_columns;
+    rows = new_rows;
+    max_column = static_cast<float>(columns - 1);
+    max_row = static_cast<float>(rows - 1);
+    levels.assign(columns * rows, params.capacity);
+    next_levels.assign(columns * rows, 0.0f);
+    demand.assign(columns * rows, 0.0f);
+}
+
+void NutrientField::fill(float level)
+{
+    std::fill(levels.begin(), levels.end(), level);
+}
+
+void NutrientField::clear_demand()
+{
+    std::fill(demand.begin(), demand.end(), 0.0f);
+}
+
+void NutrientField::step(double delta_ms, ThreadPool * pool)
+{
+    if (levels.empty())
+    {
+        return;
+    }
+    // what the counted cells ate, exactly what `feed()` gave them: a
+    // crowded grid cell is split between its cells instead of going below 0
+    double delta_sec = delta_ms / 1000.0;
+    const float uptake = params.uptake * static_cast<float>(delta_sec);
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        levels[i] -= levels[i] * std::min(uptake * demand[i], 1.0f);
+    }
+
+    // The explicit stencil oscillates and blows up once a grid cell gives
+    // away more than its own level (`keep` below 0), so long ticks are
+    // split into substeps short enough to keep it at or above 0.
+    double loss_per_sec = 4.0 * params.diffusion + params.regrowth + params.decay;
+    int substeps = std::max(1, static_cast<int>(std::ceil(delta_sec * loss_per_sec)));
+
+    // the per-second rates turned into shares of a substep, once for every cell
+    float step_sec = static_cast<float>(delta_sec / substeps);
+    StepParams step_params;
+    step_params.spread = params.diffusion * step_sec;
+    step_params.keep = std::max(1.0f - 4.0f * step_params.spread
+                                - (params.regrowth + params.decay) * step_sec, 0.0f);
+    step_params.growth = params.regrowth * step_sec * params.capacity;
+
+    for (int substep = 0; substep < substeps; ++substep)
+    {
+        // every row only reads `levels`, so rows can be stepped in any order
+        if (pool == nullptr || rows < ROW_CHUNK * 2)
+        {
+            step_rows(0, rows, step_params);
+        }
+        else
+        {
+            pool->parallel_for(rows, ROW_CHUNK, [this, &step_params](size_t begin, size_t end)
+            {
+                step_rows(begin, end, step_params);
+            });
+        }
+        levels.swap(next_levels);
+    }
+}
+
+double NutrientField::get_mean_level() const
+{
+    if (levels.empty())
+    {
+        return 0.0;
+    }
+    return std::accumulate(levels.begin(), levels.end(), 0.0)
+           / static_cast<double>(levels.size());
+}
+
+size_t NutrientField::get_columns() const
+{
+    return columns;
+}
+
+size_t NutrientField::get_rows() const
+{
+    return rows;
+}
+
+const NutrientParams & NutrientField::get_params() const
+{
+    return params;
+}
+
+void NutrientField::set_simd(bool enabled)
+{
+    use_simd = enabled;
+}
+
+bool NutrientField::is_simd() const
+{
+    return use_simd;
+}
+
+
+// ---- PRIVATE METHODS ----
+
+// One grid cell of the stencil, the SIMD kernels do the same in the same order.
+static inline float step_level(float level, float above, float below, float left, float right,
+                               float spread, float keep, float growth)
+{
+    float neighbors = (above + below) + (left + right);
+    return level * keep + spread * neighbors + growth;
+}
+
+void NutrientField::step_rows(size_t begin, size_t end, const StepParams & step_params)
+{
+    const float spread = step_params.spread;
+    const float keep = step_params.keep;
+    const float growth = step_params.growth;
+    for (size_t y = begin; y < end; ++y)
+    {
+        // past the edges a grid cell reads itself, so nothing flows out of the world
+        const float * row = &levels[y * columns];
+        const float * above = y > 0? row - columns : row;
+        const float * below = y + 1 < rows? row + columns : row;
+        float * out = &next_levels[y * columns];
+
+        out[0] = step_level(row[0], above[0], below[0], row[0], columns > 1? row[1] : row[0],
+                            spread, keep, growth);
+        size_t x = use_simd? step_row_simd(above, row, below, out, step_params) : 1;
+        for (; x < columns; ++x)
+        {
+            float right = x + 1 < columns? row[x + 1] : row[x];
+            out[x] = step_level(row[x], above[x], below[x], row[x - 1], right,
+                                spread, keep, growth);
+        }
+    }
+}
+
+size_t NutrientField::step_row_simd(const float * above, const float * row, const float * below,
+                                    float * out, const StepParams & step_params) const
+{
+    size_t x = 1;
+#if defined(__AVX__)
+    const __m256 spread = _mm256_set1_ps(step_params.spread);
+    const __m256 keep = _mm256_set1_ps(step_params.keep);
+    const __m256 growth = _mm256_set1_ps(step_params.growth);
+
+    // the right neighbor of the last lane must still be inside the row
+    for (; x + 8 < columns; x += 8)
+    {
+        __m256 neighbors = _mm256_add_ps(
+                _mm256_add_ps(_mm256_loadu_ps(&above[x]), _mm256_loadu_ps(&below[x])),
+                _mm256_add_ps(_mm256_loadu_ps(&row[x - 1]), _mm256_loadu_ps(&row[x + 1])));
+        __m256 next = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&row[x]), keep),
+                              _mm256_mul_ps(spread, neighbors)),
+                growth);
+        _mm256_storeu_ps(&out[x], next);
+    }
+#elif defined(__SSE2__)
+    const __m128 spread = _mm_set1_ps(step_params.spread);
+    const __m128 keep = _mm_set1_ps(step_params.keep);
+    const __m128 growth = _mm_set1_ps(step_params.growth);
+
+    // the right neighbor of the last lane must still be inside the row
+    for (; x + 4 < columns; x += 4)
+    {
+        __m128 neighbors = _mm_add_ps(
+                _mm_add_ps(_mm_loadu_ps(&above[x]), _mm_loadu_ps(&below[x])),
+                _mm_add_ps(_mm_loadu_ps(&row[x - 1]), _mm_loadu_ps(&row[x + 1])));
+        __m128 next = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&row[x]), keep),
+                           _mm_mul_ps(spread, neighbors)),
+                growth);
+        _mm_storeu_ps(&out[x], next);
+    }
+#else
+    // no SIMD available, everything is left for the scalar loop
+    (void) above; (void) row; (void) below; (void) out;
+    (void) step_params;
+#endif
+    return x;
+}
+
+} // namespace LCode
@@ -0,0 +1,179 @@
+#include "Replay.hpp"
+#include "LException.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+namespace LCode
+{
+
+// identifies replay files and their layout
+static const char MAGIC[4] = {'L', 'R', 'E', 'C'};
+static const std::uint32_t VERSION = 5;
+
+template <typename T>
+static void write_value(std::ofstream & file, const T & value)
+{
+    file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool read_value(std::ifstream & file, T & value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+
+std::ostream & operator << (std::ostream & os, const ReplayResult & result)
+{
+    os << "replayed:      " << result.frames << " / " << result.expected_frames << " frames\n"
+       << "checksum:      " << std::hex << result.checksum << " (expected "
+                            << result.expected_checksum << ")" << std::dec << "\n";
+    if (!result.complete)
+    {
+        os << "replay:        recording ended early, no final checksum\n";
+    }
+    return os << "replay:        " << (result.matches()? "MATCH" : "MISMATCH") << "\n";
+}
+
+
+ReplayWriter::ReplayWriter(const std::string & path, const ReplayHeader & header)
+: file{path, std::ios::binary}, finished{false}
+{
+    if (!file)
+    {
+        throw LException{"Unable to create replay file \"" + path + "\"!"};
+    }
+    file.write(MAGIC, sizeof(MAGIC));
+    write_value(file, VERSION);
+    write_value(file, header.seed);
+    write_value(file, header.tick_rate);
+    write_value(file, header.max_ticks_per_frame);
+    write_value(file, header.screen_width);
+    write_value(file, header.screen_height);
+    write_value(file, header.cells);
+    write_value(file, header.swarm_cells);
+    write_value(file, header.start_paused);
+    write_value(file, header.collisions);
+    write_value(file, header.nutrients);
+    write_value(file, header.scalar);
+    write_value(file, header.world_width);
+    write_value(file, header.world_height);
+    write_value(file, header.start_checksum);
+}
+
+void ReplayWriter::write_key(std::uint16_t scancode, bool key_down, bool repeat)
+{
+    write_value(file, ReplayRecord::Type::KEY);
+    write_value(file, scancode);
+    write_value(file, static_cast<std::uint8_t>(key_down));
+    write_value(file, static_cast<std::uint8_t>(repeat));
+}
+
+void ReplayWriter::write_resize(std::int32_t width, std::int32_t height)
+{
+    write_value(file, ReplayRecord::Type::RESIZE);
+    write_value(file, width);
+    write_value(file, height);
+}
+
+void ReplayWriter::write_frame(double frame_ms)
+{
+    write_value(file, ReplayRecord::Type::FRAME);
+    write_value(file, frame_ms);
+}
+
+void ReplayWriter::finish(std::uint64_t frames, std::uint64_t checksum)
+{
+    if (finished)
+    {
+        return;
+    }
+    write_value(file, ReplayRecord::Type::END);
+    write_value(file, frames);
+    write_value(file, checksum);
+    file.flush();
+    finished = true;
+}
+
+bool ReplayWriter::is_finished() const
+{
+    return finished;
+}
+
+
+ReplayReader::ReplayReader(const std::string & path)
+: file{path, std::ios::binary}, header{}
+{
+    if (!file)
+    {
+        throw LException{"Unable to open replay file \"" + path + "\"!"};
+    }
+    char magic[sizeof(MAGIC)] = {};
+    std::uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    if (!file || std::string(magic, sizeof(magic)) != std::string(MAGIC, sizeof(MAGIC))
+        || !read_value(file, version) || version != VERSION)
+    {
+        throw LException{"\"" + path + "\" is not a version "
+                         + std::to_string(VERSION) + " replay file!"};
+    }
+    bool ok = read_value(file, header.seed)
+              && read_value(file, header.tick_rate)
+              && read_value(file, header.max_ticks_per_frame)
+              && read_value(file, header.screen_width)
+              && read_value(file, header.screen_height)
+              && read_value(file, header.cells)
+              && read_value(file, header.swarm_cells)
+              && read_value(file, header.start_paused)
+              && read_value(file, header.collisions)
+              && read_value(file, header.nutrients)
+              && read_value(file, header.scalar)
+              && read_value(file, header.world_width)
+              && read_value(file, header.world_height)
+              && read_value(file, header.start_checksum);
+    if (!ok)
+    {
+        throw LException{"Replay file \"" + path + "\" ends inside its header!"};
+    }
+}
+
+const ReplayHeader & ReplayReader::get_header() const
+{
+    return header;
+}
+
+bool ReplayReader::next(ReplayRecord & record)
+{
+    if (!read_value(file, record.type))
+    {
+        return false;
+    }
+    bool ok = false;
+    switch (record.type)
+    {
+    case ReplayRecord::Type::KEY:
+        ok = read_value(file, record.scancode)
+             && read_value(file, record.key_down)
+             && read_value(file, record.repeat);
+        break;
+    case ReplayRecord::Type::RESIZE:
+        ok = read_value(file, record.width) && read_value(file, record.height);
+        break;
+    case ReplayRecord::Type::FRAME:
+        ok = read_value(file, record.frame_ms);
+        break;
+    case ReplayRecord::Type::END:
+        ok = read_value(file, record.frames) && read_value(file, record.checksum);
+        break;
+    }
+    if (!ok)
+    {
+        throw LException{"Replay file is corrupt or ends inside a record!"};
+    }
+    return true;
+}
+
+} // namespace LCode
@@ -3,26 +3,49 @@
 #include "random.hpp"
 #include "LException.hpp"
 #include "LTexture.hpp"
+#include "TextureCache.hpp"
+#include "LGlyphAtlas.hpp"
 #include "sdl_io.hpp"
+#include "lilyutils.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 #include <SDL2/SDL_ttf.h>
-#include <SDL2/SDL_image.h>
 
+#include <future>
 #include <iostream>
+#include <string>
 #include <vector>
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cmath>
 
 namespace LCode
 {
 
-SDLBaseGame::SDLBaseGame(int screen_width, int screen_height, int font_size)
-: entities{},
-  window{nullptr}, gpu{nullptr}, font{nullptr},
+// drawn behind the world, where the view goes past its edges
+static const SDL_Color BACKDROP_COLOR{0xC8, 0xC8, 0xC8, 0xFF};
+static const SDL_Color WORLD_COLOR{0xFF, 0xFF, 0xFF, 0xFF};
+
+SDLBaseGame::SDLBaseGame(int screen_width, int screen_height, int font_size,
+                         bool headless_mode)
+: entity_pool{}, entities{}, pending_removals{0}, removed_last_frame{0},
+  update_pool{nullptr}, updating_in_parallel{false}, pending_spawns{}, spawn_mutex{},
+  tick_ms{1000.0 / DEFAULT_TICK_RATE}, max_ticks_per_frame{DEFAULT_MAX_TICKS_PER_FRAME},
+  tick_accumulator{0}, interpolation_alpha{1.0}, ticks_last_frame{0},
+  frame_pacer{}, vsync{false}, profiler{},
+  keys_down{}, action_keys{SDL_SCANCODE_LSHIFT}, frame_context{}, update_tally{},
+  recorder{nullptr},
+  telemetry{nullptr}, removed_total{0}, telemetry_entities{0}, telemetry_removed{0},
+  world_rect{}, world_follows_window{true}, camera{}, culling{true},
+  cull_grid{CULL_CELL_SIZE}, cull_moves{}, update_merge_mutex{}, visible_entities{},
+  assets{}, load_stages{}, load_stage_end_ms{0.0},
+  window{nullptr}, gpu{nullptr}, font{nullptr}, shape_batch{},
   load_timer{}, fps_timer{},
   window_rect{},
-  frames{0}, running{false}, last_frame_time{0}, delta{0},
+  frames{0}, running{false}, headless{headless_mode},
+  last_frame_time{0}, frame_ms{0}, delta{0},
   avg_fps{0}, cur_fps{0}
 {
     if (current_instance == nullptr)
@@ -30,8 +53,17 @@ SDLBaseGame::SDLBaseGame(int screen_width, int screen_height, int font_size)
         current_instance = this;
         load_timer.start();
         seed_rand();
-        SDL_systems_init();
-        SDL_objects_init(screen_width, screen_height, font_size);
+        if (headless)
+        {
+            headless_init(screen_width, screen_height);
+            mark_load_stage("SDL init");
+        }
+        else
+        {
+            SDL_systems_init();
+            mark_load_stage("SDL init");
+            SDL_objects_init(screen_width, screen_height, font_size);
+        }
     }
     else
     {
@@ -42,39 +74,328 @@ SDLBaseGame::SDLBaseGame(int screen_width, int screen_height, int font_size)
 
 int SDLBaseGame::run()
 {
+    if (headless)
+    {
+        throw LException{"Headless games cannot open a window, use run_headless()!"};
+    }
     SDL_Event e;         // captures current event from event queue
     frames = 0;          // reset the frame count
     running = true;      // flag to exit from run loop
-    last_frame_time = 0; // (ms) var to save previous frame time to calculate delta
-    delta = 0;           // the milliseconds since the last frame
+    last_frame_time = 0; // (ms) var to save previous frame time to calculate frame_ms
+    frame_ms = 0;        // the milliseconds since the last frame
+    delta = tick_ms;     // every update simulates one tick
+    tick_accumulator = 0;
     fps_timer.start();   // start the FPS timer
+    frame_pacer.reset(fps_timer.get_ms());
+    profiler.clear();
     // -------- MAIN LOOP --------
     while (running)
     {
         // ---- EVENTS ----
-        while (SDL_PollEvent(&e) != 0
-               && running)
         {
-            system_handle_event(e); // handles SDL_QUIT and SDL_WINDOWEVENT
-            if (!running) break;
-            handle_event(e);
+            FrameProfiler::Scope scope{profiler, FramePhase::EVENTS};
+            while (SDL_PollEvent(&e) != 0
+                   && running)
+            {
+                if (recorder != nullptr && (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP))
+                {
+                    recorder->write_key(static_cast<std::uint16_t>(e.key.keysym.scancode),
+                                        e.type == SDL_KEYDOWN, e.key.repeat != 0);
+                }
+                system_handle_event(e); // handles SDL_QUIT and SDL_WINDOWEVENT
+                if (!running) break;
+                handle_event(e);
+            }
         }
         // ---- UPDATE LOGIC ----
         if (!running) break;
-        system_update();
-        update();
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::SYSTEM_UPDATE};
+            system_update();
+        }
+        if (recorder != nullptr)
+        {
+            recorder->write_frame(frame_ms);
+        }
+        run_ticks();
         // ---- SCREEN DRAWING ----
         if (!running) break;
-        system_draw_begin();
-        draw();
-        system_draw_end();
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::DRAW};
+            system_draw_begin();
+            draw();
+        }
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::FLIP};
+            system_draw_end();
+        }
+        // wait out the rest of the frame time
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::PACING};
+            frame_pacer.wait(fps_timer);
+        }
         // start a new frame
+        profiler.end_frame();
+        if (telemetry != nullptr)
+        {
+            push_telemetry(ticks_last_frame * tick_ms);
+        }
         ++frames;
     }
+    if (recorder != nullptr)
+    {
+        recorder->finish(static_cast<std::uint64_t>(frames), get_state_checksum());
+        recorder = nullptr;
+    }
     return EXIT_SUCCESS;
 }
 
 
+void SDLBaseGame::push_telemetry(double sim_ms)
+{
+    TelemetryRecord record;
+    record.frame = static_cast<std::uint64_t>(frames);
+    record.sim_ms = sim_ms;
+    record.frame_ms = frame_ms;
+    record.entities = entities.size();
+    // whatever was not there at the last record and is now was born
+    record.deaths = removed_total - telemetry_removed;
+    record.births = entities.size() + record.deaths - telemetry_entities;
+    telemetry_entities = entities.size();
+    telemetry_removed = removed_total;
+    fill_telemetry(record);
+    telemetry->push(record);
+}
+
+void SDLBaseGame::run_ticks()
+{
+    // simulate the time that passed in whole ticks
+    tick_accumulator += frame_ms;
+    ticks_last_frame = 0;
+    while (tick_accumulator >= tick_ms && running)
+    {
+        if (ticks_last_frame == max_ticks_per_frame)
+        {
+            // too far behind to catch up, drop the backlog rather than
+            // spending even longer on the next frame
+            tick_accumulator = std::fmod(tick_accumulator, tick_ms);
+            break;
+        }
+        FrameProfiler::Scope scope{profiler, FramePhase::UPDATE};
+        delta = tick_ms;
+        save_previous_states();
+        update();
+        remove_deleted_entities();
+        tick_accumulator -= tick_ms;
+        ++ticks_last_frame;
+    }
+    interpolation_alpha = tick_accumulator / tick_ms;
+}
+
+
+ReplayResult SDLBaseGame::run_replay(ReplayReader & reader)
+{
+    ReplayResult result;
+    ReplayRecord record;
+    frames = 0;
+    running = true;
+    frame_ms = 0;
+    delta = tick_ms;
+    tick_accumulator = 0;
+    keys_down.fill(false);
+    fps_timer.start();
+    profiler.clear();
+    // -------- REPLAY LOOP --------
+    // a recording ends right after the frame that stopped the game,
+    // so only its END record can come after `running` turns false
+    while (reader.next(record))
+    {
+        switch (record.type)
+        {
+        case ReplayRecord::Type::KEY:
+        {
+            SDL_Event e{};
+            e.type = record.key_down? SDL_KEYDOWN : SDL_KEYUP;
+            e.key.keysym.scancode = static_cast<SDL_Scancode>(record.scancode);
+            e.key.repeat = record.repeat;
+            system_handle_event(e);
+            handle_event(e);
+            break;
+        }
+        case ReplayRecord::Type::RESIZE:
+            window_rect.w = record.width;
+            window_rect.h = record.height;
+            update_world_rect();
+            break;
+        case ReplayRecord::Type::FRAME:
+        {
+            // the recorded wall-clock time decides the ticks, not this run's
+            frame_ms = record.frame_ms;
+            cur_fps = 1000.0 / frame_ms;
+            run_ticks();
+            if (!running)
+            {
+                // `run()` doesn't count a frame it stopped in
+                break;
+            }
+            if (!headless)
+            {
+                FrameProfiler::Scope scope{profiler, FramePhase::DRAW};
+                system_draw_begin();
+                draw();
+                system_draw_end();
+            }
+            profiler.end_frame();
+            ++frames;
+            break;
+        }
+        case ReplayRecord::Type::END:
+            result.complete = true;
+            result.expected_frames = record.frames;
+            result.expected_checksum = record.checksum;
+            running = false;
+            break;
+        }
+    }
+    running = false;
+    result.frames = static_cast<std::uint64_t>(frames);
+    result.checksum = get_state_checksum();
+    return result;
+}
+
+
+void SDLBaseGame::set_recorder(ReplayWriter * writer)
+{
+    recorder = writer;
+    if (recorder != nullptr)
+    {
+        recorder->write_resize(window_rect.w, window_rect.h);
+    }
+}
+
+void SDLBaseGame::set_telemetry(TelemetryWriter * writer)
+{
+    telemetry = writer;
+    telemetry_entities = entities.size();
+    telemetry_removed = removed_total;
+}
+
+void SDLBaseGame::fill_telemetry(TelemetryRecord &)
+{ }
+
+void SDLBaseGame::fill_frame_context(FrameContext &)
+{ }
+
+
+std::uint64_t SDLBaseGame::get_state_checksum() const
+{
+    std::uint64_t checksum = 0;
+    size_t live_entities = 0;
+    for (const LEntity * entity : entities)
+    {
+        if (!entity->deleted)
+        {
+            checksum = hash_combine(checksum, entity->get_state_hash());
+            ++live_entities;
+        }
+    }
+    return hash_combine(checksum, std::uint64_t{live_entities});
+}
+
+
+bool SDLBaseGame::is_key_down(SDL_Scancode key) const
+{
+    size_t index = static_cast<size_t>(key);
+    return index < keys_down.size() && keys_down[index];
+}
+
+void SDLBaseGame::set_action_key(InputAction action, SDL_Scancode key)
+{
+    action_keys[static_cast<size_t>(action)] = key;
+}
+
+SDL_Scancode SDLBaseGame::get_action_key(InputAction action) const
+{
+    return action_keys[static_cast<size_t>(action)];
+}
+
+const FrameContext & SDLBaseGame::get_frame_context() const
+{
+    return frame_context;
+}
+
+
+HeadlessReport SDLBaseGame::run_headless(const HeadlessConfig & config)
+{
+    if (config.max_frames <= 0 && config.max_sim_seconds <= 0.0)
+    {
+        throw LException{"Headless run needs a frame or simulated time limit!"};
+    }
+
+    HeadlessReport report;
+    report.start_entities = entities.size();
+    report.peak_entities = entities.size();
+
+    double sim_ms = 0;   // total simulated time so far
+    frames = 0;
+    running = true;
+    last_frame_time = 0;
+    frame_ms = 0;
+    delta = 0;
+    // nothing is drawn, every step lands exactly on a tick
+    interpolation_alpha = 1.0;
+    fps_timer.start();
+    profiler.clear();
+    // -------- HEADLESS LOOP --------
+    while (running
+           && (config.max_frames <= 0 || frames < config.max_frames)
+           && (config.max_sim_seconds <= 0.0 || sim_ms < config.max_sim_seconds * 1000.0))
+    {
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::SYSTEM_UPDATE};
+            system_update();
+        }
+        if (config.fixed_delta_ms > 0.0)
+        {
+            // simulate a steady frame rate regardless of how long updates take
+            delta = config.fixed_delta_ms;
+            cur_fps = 1000.0 / delta;
+        }
+        {
+            FrameProfiler::Scope scope{profiler, FramePhase::UPDATE};
+            update();
+            remove_deleted_entities();
+        }
+        profiler.end_frame();
+        if (telemetry != nullptr)
+        {
+            push_telemetry(delta);
+        }
+        sim_ms += delta;
+        report.removed_entities += removed_last_frame;
+        report.peak_entities = std::max(report.peak_entities, entities.size());
+        ++frames;
+    }
+    running = false;
+
+    report.frames = frames;
+    report.sim_seconds = sim_ms / 1000.0;
+    report.wall_seconds = fps_timer.get_seconds();
+    report.steps_per_sec = report.wall_seconds > 0.0
+                           ? static_cast<double>(frames) / report.wall_seconds
+                           : 0.0;
+    report.end_entities = entities.size();
+    report.update_threads = get_update_threads();
+    return report;
+}
+
+
+bool SDLBaseGame::is_headless() const
+{
+    return headless;
+}
+
+
 void SDLBaseGame::exit()
 {
     if (running)
@@ -94,6 +415,14 @@ void SDLBaseGame::system_handle_event(SDL_Event & e)
     {
         return exit();
     }
+    if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP)
+    {
+        size_t index = static_cast<size_t>(e.key.keysym.scancode);
+        if (index < keys_down.size())
+        {
+            keys_down[index] = e.type == SDL_KEYDOWN;
+        }
+    }
     if (e.type == SDL_WINDOWEVENT)
     {
         if (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED
@@ -101,6 +430,10 @@ void SDLBaseGame::system_handle_event(SDL_Event & e)
         {
             update_window_rect();
             std::cout << "window_rect = " << window_rect << "\n";
+            if (recorder != nullptr && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+            {
+                recorder->write_resize(window_rect.w, window_rect.h);
+            }
         }
     }
     
@@ -115,19 +448,21 @@ void SDLBaseGame::system_update()
     {
         avg_fps = 0;
     }
-    // update delta time (in ms)
-    delta = fps_timer.get_ms() - last_frame_time;
-    last_frame_time = fps_timer.get_ms();
+    // update frame time (in ms)
+    double now_ms = fps_timer.get_ms();
+    frame_ms = now_ms - last_frame_time;
+    last_frame_time = now_ms;
+    // headless steps simulate the wall-clock time unless given a fixed delta
+    delta = frame_ms;
 
-    cur_fps = 1000.0 / delta;
+    cur_fps = 1000.0 / frame_ms;
 
 }
 
 void SDLBaseGame::system_draw_begin()
 {
-    // Clear screen
-    GPU_Clear(gpu);
-    GPU_RectangleFilled(gpu, 0, 0, static_cast<float>(window_rect.w), static_cast<float>(window_rect.h), SDL_Color{0xFF, 0xFF, 0xFF, 0xFF});
+    // Clear screen, the world itself is filled in by `draw_entities()`
+    GPU_ClearColor(gpu, BACKDROP_COLOR);
 }
 
 void SDLBaseGame::system_draw_end()
@@ -153,6 +488,48 @@ const SDL_Rect & SDLBaseGame::get_window_rect()
     return window_rect;
 }
 
+void SDLBaseGame::set_world_size(int width, int height)
+{
+    world_follows_window = width <= 0 || height <= 0;
+    if (!world_follows_window)
+    {
+        world_rect = SDL_Rect{0, 0, width, height};
+    }
+    update_world_rect();
+    camera.look_at(SDL_FPoint{static_cast<float>(world_rect.w) / 2.0f,
+                              static_cast<float>(world_rect.h) / 2.0f});
+}
+
+const SDL_Rect & SDLBaseGame::get_world_rect() const
+{
+    return world_rect;
+}
+
+bool SDLBaseGame::is_world_following_window() const
+{
+    return world_follows_window;
+}
+
+Camera & SDLBaseGame::get_camera()
+{
+    return camera;
+}
+
+void SDLBaseGame::set_culling(bool enabled)
+{
+    culling = enabled;
+}
+
+bool SDLBaseGame::is_culling() const
+{
+    return culling;
+}
+
+size_t SDLBaseGame::get_drawn_last_frame() const
+{
+    return visible_entities.size();
+}
+
 
 SDL_FPoint SDLBaseGame::get_random_screen_point()
 {
@@ -166,6 +543,13 @@ float SDLBaseGame::get_random_screen_x()
 float SDLBaseGame::get_random_screen_y()
 { return rand_float<float>(0, static_cast<float>(get_instance()->get_window_rect().h)); }
 
+SDL_FPoint SDLBaseGame::get_random_world_point()
+{
+    const SDL_Rect & world = get_instance()->get_world_rect();
+    float x = rand_float<float>(0, static_cast<float>(world.w));
+    return SDL_FPoint{x, rand_float<float>(0, static_cast<float>(world.h))};
+}
+
 void SDLBaseGame::exit_game()
 {
     current_instance->exit();
@@ -180,15 +564,22 @@ SDLBaseGame::~SDLBaseGame()
 
 void SDLBaseGame::free()
 {
-    free_SDL_objects();
+    if (!headless)
+    {
+        free_SDL_objects();
+    }
     quit_SDL_systems();
 
-    // free game entities
+    // stop the update workers, then free game entities
+    update_pool = nullptr;
+    merge_pending_spawns();
     for (size_t i = 0; i < entities.size(); ++i)
     {
-        delete entities[i];
+        EntityPool::destroy(entities[i]);
     }
     entities.clear();
+    cull_grid.clear();
+    pending_removals = 0;
 
     current_instance = nullptr;
 }
@@ -202,48 +593,364 @@ const std::vector<LEntity *> & SDLBaseGame::get_entities() const
 
 LEntity * SDLBaseGame::add_entity(LEntity * new_entity)
 {
+    if (updating_in_parallel)
+    {
+        std::lock_guard<std::mutex> lock{spawn_mutex};
+        pending_spawns.push_back(new_entity);
+        return new_entity;
+    }
     entities.push_back(new_entity);
+    cull_grid.insert(new_entity);
     return new_entity;
 }
 
 LEntity * SDLBaseGame::delete_entity(LEntity * entity_to_remove)
 {
-    for (size_t i = 0; i < entities.size(); ++i)
+    // exchange so two threads deleting the same entity only count it once
+    if (entity_to_remove != nullptr && holds_entity(entity_to_remove)
+        && !entity_to_remove->deleted.exchange(true))
     {
-        if (entities[i] == entity_to_remove)
-        {
-            delete_entity(i);
-            --i;
-        }
+        ++pending_removals;
     }
     return entity_to_remove;
 }
 
 LEntity * SDLBaseGame::delete_entity(size_t index)
 {
+    return delete_entity(entities.at(index));
+}
+
+size_t SDLBaseGame::get_removed_last_frame() const
+{
+    return removed_last_frame;
+}
+
+const EntityPool & SDLBaseGame::get_entity_pool() const
+{
+    return entity_pool;
+}
+
+void SDLBaseGame::set_update_threads(size_t thread_count)
+{
+    if (thread_count == 0)
+    {
+        thread_count = ThreadPool::hardware_threads();
+    }
+    if (thread_count == get_update_threads())
+    {
+        return;
+    }
+    update_pool = thread_count > 1? std::make_unique<ThreadPool>(thread_count) : nullptr;
+}
+
+size_t SDLBaseGame::get_update_threads() const
+{
+    return update_pool != nullptr? update_pool->get_thread_count() : 1;
+}
+
+ThreadPool * SDLBaseGame::get_thread_pool()
+{
+    return update_pool.get();
+}
+
+ShapeBatch & SDLBaseGame::get_shape_batch()
+{
+    return shape_batch;
+}
+
+void SDLBaseGame::set_tick_rate(double ticks_per_second)
+{
+    if (ticks_per_second <= 0.0)
+    {
+        throw LException{"Tick rate must be above 0, got " + std::to_string(ticks_per_second)};
+    }
+    tick_ms = 1000.0 / ticks_per_second;
+}
+
+double SDLBaseGame::get_tick_rate() const
+{
+    return 1000.0 / tick_ms;
+}
+
+void SDLBaseGame::set_max_ticks_per_frame(int max_ticks)
+{
+    max_ticks_per_frame = std::max(max_ticks, 1);
+}
+
+int SDLBaseGame::get_ticks_last_frame() const
+{
+    return ticks_last_frame;
+}
+
+FrameProfiler & SDLBaseGame::get_profiler()
+{
+    return profiler;
+}
+
+const std::vector<LoadStage> & SDLBaseGame::get_load_stages() const
+{
+    return load_stages;
+}
+
+std::string SDLBaseGame::get_load_breakdown() const
+{
+    std::string breakdown;
+    for (const LoadStage & stage : load_stages)
+    {
+        if (!breakdown.empty())
+        {
+            breakdown += ", ";
+        }
+        breakdown += stage.name + " " + round_to(stage.ms, 0) + " ms";
+        if (stage.background)
+        {
+            breakdown += " (background)";
+        }
+    }
+    return breakdown;
+}
+
+AssetLoader & SDLBaseGame::get_assets()
+{
+    return assets;
+}
+
+void SDLBaseGame::mark_load_stage(const std::string & name)
+{
+    double now_ms = load_timer.get_ms();
+    load_stages.push_back(LoadStage{name, now_ms - load_stage_end_ms, false});
+    load_stage_end_ms = now_ms;
+}
+
+FramePacer & SDLBaseGame::get_frame_pacer()
+{
+    return frame_pacer;
+}
+
+void SDLBaseGame::set_vsync(bool enabled)
+{
+    if (headless)
+    {
+        return;
+    }
+    if (SDL_GL_SetSwapInterval(enabled? 1 : 0) < 0)
+    {
+        std::cerr << "Warning: Unable to " << (enabled? "enable" : "disable")
+                  << " vsync! SDL Error: " << SDL_GetError() << "\n";
+        return;
+    }
+    vsync = enabled;
+}
+
+bool SDLBaseGame::is_vsync() const
+{
+    return vsync;
+}
 
-    LEntity * ret = entities.at(index);
-    delete entities.at(index);
-    entities.erase(entities.begin() + index);
-    return ret;
+double SDLBaseGame::get_interpolation_alpha() const
+{
+    return interpolation_alpha;
+}
+
+void SDLBaseGame::save_previous_states()
+{
+    for (LEntity * entity : entities)
+    {
+        entity->save_previous_state();
+    }
 }
 
 void SDLBaseGame::update_entities()
 {
-    // use explicit size check in case multiple entities were deleted at once
+    // entities per chunk handed to an update thread
+    static const size_t ENTITY_CHUNK = 256;
+    FrameProfiler::Scope scope{profiler, FramePhase::UPDATE_ENTITIES};
+
+    // read the game state once for every entity, workers only read the copy
+    frame_context.delta_ms = delta;
+    frame_context.world = world_rect;
+    for (size_t i = 0; i < action_keys.size(); ++i)
+    {
+        frame_context.input.actions[i] = is_key_down(action_keys[i]);
+    }
+    fill_frame_context(frame_context);
+    frame_context.tally = &update_tally;
+    const FrameContext & context = frame_context;
+
+    if (update_pool == nullptr || entities.size() < ENTITY_CHUNK * 2)
+    {
+        // entities added during the loop are updated this frame too
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            if (!entities[i]->deleted)
+            {
+                entities[i]->update(context);
+                cull_grid.refresh(entities[i]);
+            }
+        }
+        return;
+    }
+
+    // a `parallel_for` inside the fan-out below would run on one thread,
+    // so entities that split their own work get the whole pool first
     for (size_t i = 0; i < entities.size(); ++i)
     {
-        entities.at(i)->update(delta);
+        if (!entities[i]->deleted && entities[i]->splits_own_update())
+        {
+            entities[i]->update(context);
+            cull_grid.refresh(entities[i]);
+        }
     }
+
+    // `entities` can't grow while the workers are reading it, so spawns
+    // are queued and merged in once everyone is done
+    updating_in_parallel = true;
+    try
+    {
+        update_pool->parallel_for(entities.size(), ENTITY_CHUNK,
+            [this, &context](size_t begin, size_t end)
+            {
+                // each chunk tallies on its own, merged once at the end
+                UpdateTally tally;
+                FrameContext chunk_context = context;
+                chunk_context.tally = &tally;
+                // the grid can't change while other threads read it, so
+                // entities that changed bucket are only collected here
+                std::vector<LEntity *> moved;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (!entities[i]->deleted && !entities[i]->splits_own_update())
+                    {
+                        entities[i]->update(chunk_context);
+                        if (cull_grid.has_moved(*entities[i]))
+                        {
+                            moved.push_back(entities[i]);
+                        }
+                    }
+                }
+                std::lock_guard<std::mutex> lock{update_merge_mutex};
+                update_tally += tally;
+                cull_moves.insert(cull_moves.end(), moved.begin(), moved.end());
+            });
+    }
+    catch (...)
+    {
+        updating_in_parallel = false;
+        cull_moves.clear();
+        merge_pending_spawns();
+        throw;
+    }
+    updating_in_parallel = false;
+    for (LEntity * entity : cull_moves)
+    {
+        cull_grid.refresh(entity);
+    }
+    cull_moves.clear();
+    merge_pending_spawns();
+}
+
+void SDLBaseGame::entity_moved(LEntity * entity)
+{
+    cull_grid.refresh(entity);
+}
+
+UpdateTally SDLBaseGame::take_update_tally()
+{
+    UpdateTally tally = update_tally;
+    update_tally = UpdateTally{};
+    return tally;
+}
+
+void SDLBaseGame::merge_pending_spawns()
+{
+    for (LEntity * entity : pending_spawns)
+    {
+        entities.push_back(entity);
+        cull_grid.insert(entity);
+    }
+    pending_spawns.clear();
+}
+
+bool SDLBaseGame::holds_entity(LEntity * entity)
+{
+    // everything in `entities` is in the cull grid too
+    if (entity->cull_bucket != CullGrid::NOT_ADDED)
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock{spawn_mutex};
+    return std::find(pending_spawns.begin(), pending_spawns.end(), entity) != pending_spawns.end();
+}
+
+void SDLBaseGame::remove_deleted_entities()
+{
+    removed_last_frame = 0;
+    if (pending_removals == 0)
+    {
+        return;
+    }
+    // keep the survivors in order, deallocating the rest as we go
+    size_t kept = 0;
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        if (entities[i]->deleted)
+        {
+            cull_grid.remove(entities[i]);
+            EntityPool::destroy(entities[i]);
+            ++removed_last_frame;
+        }
+        else
+        {
+            entities[kept++] = entities[i];
+        }
+    }
+    entities.resize(kept);
+    removed_total += removed_last_frame;
+    pending_removals = 0;
 }
 
 void SDLBaseGame::draw_entities()
 {
-    // draw all entities (size of entities should stay constant here)
-    for (LEntity * entity : entities)
+    FrameProfiler::Scope scope{profiler, FramePhase::DRAW_ENTITIES};
+    find_visible_entities();
+
+    // draw in world coordinates
+    GPU_Camera view = camera.to_gpu_camera();
+    GPU_SetCamera(gpu, &view);
+    shape_batch.set_scale(camera.get_zoom());
+    GPU_RectangleFilled(gpu, 0, 0, static_cast<float>(world_rect.w),
+                        static_cast<float>(world_rect.h), WORLD_COLOR);
+    for (LEntity * entity : visible_entities)
     {
         entity->draw(gpu);
     }
+    shape_batch.flush(gpu);
+    for (LEntity * entity : visible_entities)
+    {
+        entity->draw_overlay(gpu);
+    }
+    // back to screen coordinates for whatever the subclass draws next
+    GPU_SetCamera(gpu, nullptr);
+}
+
+void SDLBaseGame::find_visible_entities()
+{
+    if (!culling)
+    {
+        visible_entities.clear();
+        for (LEntity * entity : entities)
+        {
+            if (!entity->deleted)
+            {
+                visible_entities.push_back(entity);
+            }
+        }
+        return;
+    }
+    SDL_FRect view = camera.get_view();
+    view = SDL_FRect{view.x - CULL_MARGIN, view.y - CULL_MARGIN,
+                     view.w + 2.0f * CULL_MARGIN, view.h + 2.0f * CULL_MARGIN};
+    cull_grid.find_visible(view, visible_entities);
 }
 
 void SDLBaseGame::SDL_systems_init()
@@ -263,19 +970,7 @@ void SDLBaseGame::SDL_systems_init()
             std::cerr << "Warning: Linear texture filtering not enabled!\n";
         }
 
-        // SDL_image Init
-        if ( ! (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) )
-        {
-            throw LException{"Could not initialize SDL_image for PNG loading! SDL_image Error: "
-                    + std::string{IMG_GetError()} + '\n'};
-        }
-        // SDL_ttf Init
-        if (TTF_Init() < 0)
-        {
-            throw LException{"Could not initialize SDL_ttf for font loading! SDL_ttf Error: "
-                    + std::string{TTF_GetError()} + '\n'};
-        }
-
+        // SDL_ttf and SDL_image are initialized by `assets` when first needed
         systems_initialized = true;
     }
 }
@@ -284,46 +979,84 @@ void SDLBaseGame::SDL_systems_init()
 void SDLBaseGame::SDL_objects_init(int screen_width, int screen_height,
                                    int font_size)
 {
-    
-    font = TTF_OpenFont("assets/Sol Schori.ttf", font_size);
-    if (font == nullptr)
-    {
-        throw LException{"Failed to load font! SDL_ttf Error: "
-                         + std::string{TTF_GetError()} + '\n'};
-    }
+    // open the font on another thread while the window and GPU come up
+    std::future<LoadedFont> font_loading = assets.load_font_async(FONT_PATH, font_size);
 
-    window = SDL_CreateWindow("Hello SDL2!",
-                                SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-                                screen_width, screen_height,
-                                SDL_WINDOW_OPENGL | // Needed to work with SDL_gpu
-                                SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+    try
+    {
+        window = SDL_CreateWindow("Hello SDL2!",
+                                    SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                                    screen_width, screen_height,
+                                    SDL_WINDOW_OPENGL | // Needed to work with SDL_gpu
+                                    SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
 
-    Uint32 window_id = SDL_GetWindowID(window);
-    GPU_SetInitWindow(window_id);
-    gpu = GPU_Init(static_cast<Uint16>(screen_width), static_cast<Uint16>(screen_height), GPU_DEFAULT_INIT_FLAGS);
-    if (gpu == nullptr)
+        Uint32 window_id = SDL_GetWindowID(window);
+        GPU_SetInitWindow(window_id);
+        gpu = GPU_Init(static_cast<Uint16>(screen_width), static_cast<Uint16>(screen_height), GPU_DEFAULT_INIT_FLAGS);
+        if (gpu == nullptr)
+        {
+            GPU_ErrorObject error = GPU_PopErrorCode();
+            std::string details;
+            if (error.details != nullptr)
+            {
+                details = GPU_PopErrorCode().details;
+            }
+            else
+            {
+                details = SDL_GetError();
+            }
+            throw LException{"Could not initialize SDL_gpu: " + details};
+        }
+    }
+    catch (...)
     {
-        GPU_ErrorObject error = GPU_PopErrorCode();
-        std::string details;
-        if (error.details != nullptr)
+        // nothing takes the font if this fails, so wait for it and close it
+        try
         {
-            details = GPU_PopErrorCode().details;
+            TTF_CloseFont(font_loading.get().asset);
         }
-        else
+        catch (const LException &)
         {
-            details = SDL_GetError();
+            // the font failed to load too, there is nothing to close
         }
-        throw LException{"Could not initialize SDL_gpu: " + details};
+        throw;
     }
     update_window_rect();
-
     LTexture::set_fallback_gpu(gpu);
+    mark_load_stage("window + GPU");
+
+    LoadedFont loaded_font = font_loading.get();
+    font = loaded_font.asset;
     LTexture::set_fallback_font(font);
+    mark_load_stage("font wait");
+    load_stages.push_back(LoadStage{"font", loaded_font.load_ms, true});
+}
+
+
+void SDLBaseGame::headless_init(int screen_width, int screen_height)
+{
+    if (!systems_initialized)
+    {
+        // only the timer is needed to measure deltas, no video/GPU/fonts
+        if (SDL_Init(SDL_INIT_TIMER) < 0)
+        {
+            throw LException{"Could not initialize SDL2 timer: "
+                             + std::string{SDL_GetError()} + '\n'};
+        }
+        systems_initialized = true;
+    }
+    // virtual screen that entities are simulated inside of
+    window_rect = SDL_Rect{0, 0, screen_width, screen_height};
+    update_world_rect();
 }
 
 
 void SDLBaseGame::free_SDL_objects()
 {
+    // glyph atlases hold GPU images rendered from `font`
+    LGlyphAtlas::free_all();
+    // text images are cached by font pointer, which is about to be reused
+    TextureCache::clear();
     TTF_CloseFont(font);
     font = nullptr;
     GPU_FreeTarget(gpu);
@@ -336,9 +1069,11 @@ void SDLBaseGame::quit_SDL_systems()
 {
     if (systems_initialized)
     {
-        TTF_Quit();
-        IMG_Quit();
-        GPU_Quit();
+        assets.quit();
+        if (!headless)
+        {
+            GPU_Quit();
+        }
         SDL_Quit();
         systems_initialized = false;
     }
@@ -352,6 +1087,19 @@ void SDLBaseGame::update_window_rect()
 {
     SDL_GetWindowPosition(window, &window_rect.x, &window_rect.y);
     SDL_GetWindowSizeInPixels(window, &window_rect.w, &window_rect.h);
+    update_world_rect();
+}
+
+void SDLBaseGame::update_world_rect()
+{
+    camera.set_viewport(window_rect.w, window_rect.h);
+    if (world_follows_window)
+    {
+        world_rect = SDL_Rect{0, 0, window_rect.w, window_rect.h};
+        camera.look_at(SDL_FPoint{static_cast<float>(world_rect.w) / 2.0f,
+                                  static_cast<float>(world_rect.h) / 2.0f});
+    }
+    cull_grid.resize(static_cast<float>(world_rect.w), static_cast<float>(world_rect.h));
 }
 
 } // namespace LCode
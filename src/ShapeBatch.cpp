@@ -0,0 +1,206 @@
+#include "ShapeBatch.hpp"
+#include "sdl_math.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+namespace LCode
+{
+
+// SDL_Color to the 0.0 - 1.0 floats GPU_BATCH_XY_RGBA expects
+static void to_rgba(SDL_Color color, float rgba[4])
+{
+    rgba[0] = static_cast<float>(color.r) / 255.0f;
+    rgba[1] = static_cast<float>(color.g) / 255.0f;
+    rgba[2] = static_cast<float>(color.b) / 255.0f;
+    rgba[3] = static_cast<float>(color.a) / 255.0f;
+}
+
+
+ShapeBatch::ShapeBatch()
+: chunks{}, active_chunks{0}, unit_circles{}, scale{1.0f},
+  draw_calls{0}, vertex_count{0}, triangle_count{0}
+{ }
+
+int ShapeBatch::get_segments(float radius)
+{
+    // roughly one segment every 12 pixels of circumference
+    return std::clamp(static_cast<int>(radius * 0.5f), MIN_SEGMENTS, MAX_SEGMENTS);
+}
+
+void ShapeBatch::add_filled_circle(float x, float y, float radius, SDL_Color color)
+{
+    if (radius <= 0.0f)
+    {
+        return;
+    }
+    int segments = get_segments(radius * scale);
+    const UnitCircle & circle = get_unit_circle(segments);
+    Chunk & chunk = reserve(static_cast<size_t>(segments) + 1);
+    float rgba[4];
+    to_rgba(color, rgba);
+
+    // a fan around the center vertex
+    unsigned short center = static_cast<unsigned short>(chunk.vertices.size() / FLOATS_PER_VERTEX);
+    push_vertex(chunk, x, y, rgba);
+    for (int i = 0; i < segments; ++i)
+    {
+        push_vertex(chunk, x + circle.cos[i] * radius, y + circle.sin[i] * radius, rgba);
+        chunk.indices.push_back(center);
+        chunk.indices.push_back(static_cast<unsigned short>(center + 1 + i));
+        chunk.indices.push_back(static_cast<unsigned short>(center + 1 + (i + 1) % segments));
+    }
+}
+
+void ShapeBatch::add_ring(float x, float y, float inner_radius, float outer_radius,
+                          SDL_Color color)
+{
+    inner_radius = std::max(inner_radius, 0.0f);
+    if (outer_radius <= inner_radius)
+    {
+        return;
+    }
+    int segments = get_segments(outer_radius * scale);
+    const UnitCircle & circle = get_unit_circle(segments);
+    Chunk & chunk = reserve(static_cast<size_t>(segments) * 2);
+    float rgba[4];
+    to_rgba(color, rgba);
+
+    // a strip of quads between alternating inner and outer vertices
+    unsigned short first = static_cast<unsigned short>(chunk.vertices.size() / FLOATS_PER_VERTEX);
+    for (int i = 0; i < segments; ++i)
+    {
+        push_vertex(chunk, x + circle.cos[i] * inner_radius, y + circle.sin[i] * inner_radius, rgba);
+        push_vertex(chunk, x + circle.cos[i] * outer_radius, y + circle.sin[i] * outer_radius, rgba);
+
+        unsigned short inner = static_cast<unsigned short>(first + 2 * i);
+        unsigned short next_inner = static_cast<unsigned short>(first + 2 * ((i + 1) % segments));
+        chunk.indices.insert(chunk.indices.end(),
+            {inner, static_cast<unsigned short>(inner + 1), next_inner,
+             next_inner, static_cast<unsigned short>(inner + 1),
+             static_cast<unsigned short>(next_inner + 1)});
+    }
+}
+
+void ShapeBatch::add_rectangle(float x1, float y1, float x2, float y2, SDL_Color color)
+{
+    Chunk & chunk = reserve(4);
+    float rgba[4];
+    to_rgba(color, rgba);
+
+    unsigned short first = static_cast<unsigned short>(chunk.vertices.size() / FLOATS_PER_VERTEX);
+    push_vertex(chunk, x1, y1, rgba);
+    push_vertex(chunk, x2, y1, rgba);
+    push_vertex(chunk, x2, y2, rgba);
+    push_vertex(chunk, x1, y2, rgba);
+    chunk.indices.insert(chunk.indices.end(),
+        {first, static_cast<unsigned short>(first + 1), static_cast<unsigned short>(first + 2),
+         first, static_cast<unsigned short>(first + 2), static_cast<unsigned short>(first + 3)});
+}
+
+void ShapeBatch::flush(GPU_Target * gpu)
+{
+    draw_calls = 0;
+    vertex_count = 0;
+    triangle_count = 0;
+    for (size_t i = 0; i < active_chunks; ++i)
+    {
+        Chunk & chunk = chunks[i];
+        size_t vertices = chunk.vertices.size() / FLOATS_PER_VERTEX;
+        if (vertices > 0)
+        {
+            GPU_TriangleBatch(nullptr, gpu, static_cast<unsigned short>(vertices),
+                              chunk.vertices.data(),
+                              static_cast<unsigned int>(chunk.indices.size()),
+                              chunk.indices.data(), GPU_BATCH_XY_RGBA);
+            ++draw_calls;
+            vertex_count += vertices;
+            triangle_count += chunk.indices.size() / 3;
+        }
+    }
+    clear();
+}
+
+void ShapeBatch::clear()
+{
+    for (size_t i = 0; i < active_chunks; ++i)
+    {
+        chunks[i].vertices.clear();
+        chunks[i].indices.clear();
+    }
+    active_chunks = 0;
+}
+
+void ShapeBatch::set_scale(float pixels_per_unit)
+{
+    scale = pixels_per_unit;
+}
+
+float ShapeBatch::get_scale() const
+{
+    return scale;
+}
+
+size_t ShapeBatch::get_draw_calls() const
+{
+    return draw_calls;
+}
+
+size_t ShapeBatch::get_vertex_count() const
+{
+    return vertex_count;
+}
+
+size_t ShapeBatch::get_triangle_count() const
+{
+    return triangle_count;
+}
+
+ShapeBatch::Chunk & ShapeBatch::reserve(size_t vertices)
+{
+    if (active_chunks > 0)
+    {
+        Chunk & current = chunks[active_chunks - 1];
+        if (current.vertices.size() / FLOATS_PER_VERTEX + vertices <= MAX_CHUNK_VERTICES)
+        {
+            return current;
+        }
+    }
+    // start a new chunk, reusing one from a previous frame if possible
+    if (active_chunks == chunks.size())
+    {
+        chunks.emplace_back();
+    }
+    return chunks[active_chunks++];
+}
+
+const ShapeBatch::UnitCircle & ShapeBatch::get_unit_circle(int segments)
+{
+    UnitCircle & circle = unit_circles[static_cast<size_t>(segments)];
+    if (circle.cos.empty())
+    {
+        circle.cos.resize(static_cast<size_t>(segments));
+        circle.sin.resize(static_cast<size_t>(segments));
+        for (int i = 0; i < segments; ++i)
+        {
+            float angle = 2.0f * M_PI_F * static_cast<float>(i) / static_cast<float>(segments);
+            circle.cos[static_cast<size_t>(i)] = std::cos(angle);
+            circle.sin[static_cast<size_t>(i)] = std::sin(angle);
+        }
+    }
+    return circle;
+}
+
+void ShapeBatch::push_vertex(Chunk & chunk, float x, float y, const float rgba[4])
+{
+    chunk.vertices.insert(chunk.vertices.end(), {x, y, rgba[0], rgba[1], rgba[2], rgba[3]});
+}
+
+} // namespace LCode
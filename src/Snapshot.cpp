@@ -0,0 +1,89 @@
+#include "Snapshot.hpp"
+#include "LException.hpp"
+
+#include <fstream>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace LCode
+{
+
+SnapshotWriter::SnapshotWriter(const std::string & file_path, SnapshotHeader header)
+: file{file_path, std::ios::binary}, path{file_path}
+{
+    if (!file)
+    {
+        throw LException{"Unable to create snapshot file \"" + path + "\"!"};
+    }
+    header.version = SnapshotReader::VERSION;
+    header.byte_order = SnapshotReader::BYTE_ORDER_MARK;
+    write_bytes(&header, sizeof(header));
+}
+
+void SnapshotWriter::finish()
+{
+    file.flush();
+    if (!file)
+    {
+        throw LException{"Unable to write snapshot file \"" + path + "\"!"};
+    }
+}
+
+void SnapshotWriter::write_bytes(const void * bytes, size_t size)
+{
+    file.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(size));
+}
+
+
+SnapshotReader::SnapshotReader(const std::string & file_path)
+: file{file_path, std::ios::binary}, path{file_path}, header{}
+{
+    if (!file)
+    {
+        throw LException{"Unable to open snapshot file \"" + path + "\"!"};
+    }
+    const SnapshotHeader expected{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+        || header.version != VERSION)
+    {
+        throw LException{"\"" + path + "\" is not a version "
+                         + std::to_string(VERSION) + " snapshot file!"};
+    }
+    if (header.byte_order != BYTE_ORDER_MARK)
+    {
+        throw LException{"Snapshot file \"" + path + "\" was saved with another byte order!"};
+    }
+    // check the size up front, so a cut off file fails before anything is replaced
+    file.seekg(0, std::ios::end);
+    std::uint64_t size = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(static_cast<std::streamoff>(sizeof(header)), std::ios::beg);
+    if (size != get_file_size(header))
+    {
+        throw LException{"Snapshot file \"" + path + "\" is " + std::to_string(size)
+                         + " bytes, expected " + std::to_string(get_file_size(header)) + "!"};
+    }
+}
+
+const SnapshotHeader & SnapshotReader::get_header() const
+{
+    return header;
+}
+
+std::uint64_t SnapshotReader::get_file_size(const SnapshotHeader & snapshot_header)
+{
+    return sizeof(SnapshotHeader) + snapshot_header.cells * sizeof(CellRecord)
+           + snapshot_header.swarm_cells * SWARM_CELL_BYTES;
+}
+
+void SnapshotReader::read_bytes(void * bytes, size_t size)
+{
+    if (!file.read(static_cast<char *>(bytes), static_cast<std::streamsize>(size)))
+    {
+        throw LException{"Snapshot file \"" + path + "\" ends early!"};
+    }
+}
+
+} // namespace LCode
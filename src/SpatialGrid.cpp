@@ -0,0 +1,93 @@
+#include "SpatialGrid.hpp"
+#include "LException.hpp"
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+SpatialGrid::SpatialGrid(float bucket_size)
+: cell_size{1.0f}, inv_cell_size{1.0f}, columns{1}, rows{1},
+  cell_start(2, 0), items{}, item_cells{}, cursors{}
+{
+    set_cell_size(bucket_size);
+}
+
+SpatialGrid::~SpatialGrid() = default;
+
+void SpatialGrid::set_cell_size(float bucket_size)
+{
+    if (!(bucket_size > 0.0f))
+    {
+        throw LException{"SpatialGrid bucket size must be positive!"};
+    }
+    cell_size = bucket_size;
+    inv_cell_size = 1.0f / bucket_size;
+}
+
+float SpatialGrid::get_cell_size() const
+{
+    return cell_size;
+}
+
+void SpatialGrid::build(const float * xs, const float * ys, size_t count,
+                        float width, float height)
+{
+    columns = std::max(1, static_cast<int>(std::ceil(width * inv_cell_size)));
+    rows = std::max(1, static_cast<int>(std::ceil(height * inv_cell_size)));
+    size_t cell_count = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+
+    // count the points in each bucket...
+    cell_start.assign(cell_count + 1, 0);
+    item_cells.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::uint32_t cell = static_cast<std::uint32_t>(get_row(ys[i]) * columns
+                                                        + get_column(xs[i]));
+        item_cells[i] = cell;
+        ++cell_start[cell + 1];
+    }
+    // ...turn the counts into where each bucket starts...
+    for (size_t cell = 0; cell < cell_count; ++cell)
+    {
+        cell_start[cell + 1] += cell_start[cell];
+    }
+    // ...and place the points, in index order within each bucket
+    cursors.assign(cell_start.begin(), cell_start.end() - 1);
+    items.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        items[cursors[item_cells[i]]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+int SpatialGrid::get_columns() const
+{
+    return columns;
+}
+
+int SpatialGrid::get_rows() const
+{
+    return rows;
+}
+
+size_t SpatialGrid::get_item_count() const
+{
+    return items.size();
+}
+
+size_t SpatialGrid::get_max_occupancy() const
+{
+    std::uint32_t most = 0;
+    for (size_t cell = 0; cell + 1 < cell_start.size(); ++cell)
+    {
+        most = std::max(most, cell_start[cell + 1] - cell_start[cell]);
+    }
+    return most;
+}
+
+} // namespace LCode
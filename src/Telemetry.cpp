@@ -0,0 +1,185 @@
+#include "Telemetry.hpp"
+#include "LException.hpp"
+#include "lilyutils.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+
+// identifies binary telemetry files
+static const char MAGIC[4] = {'L', 'T', 'E', 'L'};
+static const char * const CSV_HEADER
+    = "frame,sim_ms,frame_ms,entities,cells,births,deaths,mean_life\n";
+// longest CSV line, a field too wide for it (only absurd doubles) is left out
+static const size_t CSV_LINE_CAPACITY = 256;
+
+
+TelemetryWriter::TelemetryWriter(const std::string & file_path, TelemetryFormat file_format)
+: file{file_path, file_format == TelemetryFormat::BINARY? std::ios::binary : std::ios::out},
+  path{file_path}, format{file_format}, queue{std::make_unique<Queue>()},
+  pushed{0}, dropped{0}, written{0}, write_failed{false}, stopping{false},
+  writer_thread{}
+{
+    if (!file)
+    {
+        throw LException{"Unable to create telemetry file \"" + path + "\"!"};
+    }
+    if (format == TelemetryFormat::CSV)
+    {
+        file << CSV_HEADER;
+    }
+    else
+    {
+        std::uint32_t record_size = sizeof(TelemetryRecord);
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char *>(&BINARY_VERSION), sizeof(BINARY_VERSION));
+        file.write(reinterpret_cast<const char *>(&record_size), sizeof(record_size));
+    }
+    // started last, once everything it uses is set up
+    writer_thread = std::thread{&TelemetryWriter::write_loop, this};
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+    close();
+}
+
+bool TelemetryWriter::push(const TelemetryRecord & record)
+{
+    ++pushed;
+    if (stopping || !queue->try_push(record))
+    {
+        ++dropped;
+        return false;
+    }
+    return true;
+}
+
+void TelemetryWriter::close()
+{
+    stopping = true;
+    if (writer_thread.joinable())
+    {
+        writer_thread.join();
+    }
+}
+
+std::uint64_t TelemetryWriter::get_pushed() const
+{
+    return pushed;
+}
+
+std::uint64_t TelemetryWriter::get_dropped() const
+{
+    return dropped;
+}
+
+std::uint64_t TelemetryWriter::get_written() const
+{
+    return written;
+}
+
+bool TelemetryWriter::has_failed() const
+{
+    return write_failed;
+}
+
+const std::string & TelemetryWriter::get_path() const
+{
+    return path;
+}
+
+TelemetryFormat TelemetryWriter::format_for(const std::string & file_path)
+{
+    const std::string extension = ".csv";
+    bool is_csv = file_path.size() >= extension.size()
+                  && file_path.compare(file_path.size() - extension.size(),
+                                       extension.size(), extension) == 0;
+    return is_csv? TelemetryFormat::CSV : TelemetryFormat::BINARY;
+}
+
+void TelemetryWriter::write_loop()
+{
+    std::string buffer;
+    while (true)
+    {
+        // read the flag first, so everything pushed before it was set is drained
+        bool last_pass = stopping;
+        if (write_batch(buffer) == 0)
+        {
+            if (last_pass)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{IDLE_WAIT_MS});
+        }
+    }
+    file.flush();
+    if (!file)
+    {
+        write_failed = true;
+    }
+}
+
+size_t TelemetryWriter::write_batch(std::string & buffer)
+{
+    buffer.clear();
+    size_t count = 0;
+    TelemetryRecord record;
+    TextBuffer<CSV_LINE_CAPACITY> line;
+    while (queue->try_pop(record))
+    {
+        if (format == TelemetryFormat::CSV)
+        {
+            line.clear();
+            line.append(record.frame).append(",")
+                .append(record.sim_ms, 3).append(",")
+                .append(record.frame_ms, 3).append(",")
+                .append(record.entities).append(",")
+                .append(record.cells).append(",")
+                .append(record.births).append(",")
+                .append(record.deaths).append(",")
+                .append(record.mean_life, 3).append("\n");
+            buffer.append(line.view());
+        }
+        else
+        {
+            buffer.append(reinterpret_cast<const char *>(&record), sizeof(record));
+        }
+        ++count;
+    }
+    if (count > 0)
+    {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!file)
+        {
+            write_failed = true;
+        }
+        written.fetch_add(count, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+
+std::ostream & operator << (std::ostream & os, const TelemetryWriter & writer)
+{
+    os << "telemetry:     " << writer.get_written() << " / " << writer.get_pushed()
+       << " records written to " << writer.get_path() << " (" << writer.get_dropped()
+       << " dropped)\n";
+    if (writer.has_failed())
+    {
+        os << "telemetry:     writing to " << writer.get_path() << " failed!\n";
+    }
+    return os;
+}
+
+} // namespace LCode
@@ -0,0 +1,175 @@
+#include "TextureCache.hpp"
+#include "LException.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace LCode
+{
+// ---- Static initializers ----
+std::unordered_map<std::string, std::weak_ptr<GPU_Image>> TextureCache::images{};
+std::unordered_map<TextureCache::TextKey, std::weak_ptr<GPU_Image>,
+                   TextureCache::TextKeyHash> TextureCache::texts{};
+size_t TextureCache::images_prune_size = TextureCache::MIN_PRUNE_SIZE;
+size_t TextureCache::texts_prune_size = TextureCache::MIN_PRUNE_SIZE;
+std::uint64_t TextureCache::hits = 0;
+std::uint64_t TextureCache::misses = 0;
+
+
+bool TextureCache::TextKey::operator == (const TextKey & other) const
+{
+    return font == other.font
+           && color.r == other.color.r && color.g == other.color.g
+           && color.b == other.color.b && color.a == other.color.a
+           && text == other.text;
+}
+
+size_t TextureCache::TextKeyHash::operator () (const TextKey & key) const
+{
+    std::uint32_t rgba = static_cast<std::uint32_t>(key.color.r) << 24
+                         | static_cast<std::uint32_t>(key.color.g) << 16
+                         | static_cast<std::uint32_t>(key.color.b) << 8
+                         | static_cast<std::uint32_t>(key.color.a);
+    size_t hash = std::hash<std::string>{}(key.text);
+    hash ^= std::hash<TTF_Font *>{}(key.font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<std::uint32_t>{}(rgba) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+
+ImageHandle TextureCache::load_image(const std::string & path)
+{
+    std::weak_ptr<GPU_Image> & entry = images[path];
+    if (ImageHandle image = entry.lock())
+    {
+        ++hits;
+        return image;
+    }
+    ++misses;
+
+    GPU_Image * loaded = GPU_LoadImage(path.c_str());
+    if (loaded == nullptr)
+    {
+        images.erase(path);
+        throw LException{"Unable to load image file into surface at \"" + path
+                + "\"! SDL Error: " + std::string{SDL_GetError()} + '\n'};
+    }
+    ImageHandle image = make_handle(loaded);
+    entry = image;
+    prune(images, images_prune_size);
+    return image;
+}
+
+ImageHandle TextureCache::load_text(const std::string & text, TTF_Font * font, SDL_Color color)
+{
+    TextKey key{text, font, color};
+    std::weak_ptr<GPU_Image> & entry = texts[key];
+    if (ImageHandle image = entry.lock())
+    {
+        ++hits;
+        return image;
+    }
+    ++misses;
+
+    // render text to a surface
+    SDL_Surface * text_surface = TTF_RenderText_Solid(font, text.c_str(), color);
+    if (text_surface == nullptr)
+    {
+        texts.erase(key);
+        throw LException{"Unable to render text surface! SDL_TTF Error: "
+                         + std::string{TTF_GetError()} + '\n'};
+    }
+    // create texture from surface pixels
+    GPU_Image * rendered = GPU_CopyImageFromSurface(text_surface);
+    SDL_FreeSurface(text_surface);
+    if (rendered == nullptr)
+    {
+        texts.erase(key);
+        throw LException{"Unable to create texture from rendered text surface! SDL Error: "
+                         + std::string{SDL_GetError()} + '\n'};
+    }
+    ImageHandle image = make_handle(rendered);
+    entry = image;
+    prune(texts, texts_prune_size);
+    return image;
+}
+
+TextureCacheStats TextureCache::get_stats()
+{
+    auto is_live = [](const auto & entry)
+    {
+        return !entry.second.expired();
+    };
+    TextureCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.live = static_cast<size_t>(std::count_if(images.begin(), images.end(), is_live)
+                                     + std::count_if(texts.begin(), texts.end(), is_live));
+    return stats;
+}
+
+void TextureCache::reset_stats()
+{
+    hits = 0;
+    misses = 0;
+}
+
+void TextureCache::clear()
+{
+    images.clear();
+    texts.clear();
+    images_prune_size = MIN_PRUNE_SIZE;
+    texts_prune_size = MIN_PRUNE_SIZE;
+}
+
+
+// ---- PRIVATE METHODS ----
+
+ImageHandle TextureCache::make_handle(GPU_Image * image)
+{
+    return ImageHandle{image, [](GPU_Image * freed)
+    {
+        GPU_FreeImage(freed);
+    }};
+}
+
+template <typename MapT>
+void TextureCache::prune(MapT & map, size_t & prune_size)
+{
+    if (map.size() < prune_size)
+    {
+        return;
+    }
+    for (auto it = map.begin(); it != map.end(); )
+    {
+        if (it->second.expired())
+        {
+            it = map.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    prune_size = std::max(MIN_PRUNE_SIZE, map.size() * 2);
+}
+
+
+std::ostream & operator << (std::ostream & os, const TextureCacheStats & stats)
+{
+    os << "textures:      " << stats.live << " cached, " << stats.hits << " hits, "
+       << stats.misses << " misses\n";
+    return os;
+}
+
+} // namespace LCode
@@ -0,0 +1,145 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <cstddef>
+
+namespace LCode
+{
+
+// true on any thread currently running chunks of a job
+static thread_local bool inside_job = false;
+
+
+ThreadPool::ThreadPool(size_t thread_count)
+: workers{}, mutex{}, start_condition{}, done_condition{},
+  job{nullptr}, job_count{0}, job_chunk{1}, next_index{0},
+  busy_workers{0}, generation{0}, job_error{}, stopping{false}
+{
+    if (thread_count == 0)
+    {
+        thread_count = hardware_threads();
+    }
+    // the calling thread is the first worker
+    workers.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i)
+    {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    start_condition.notify_all();
+    for (std::thread & worker : workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::get_thread_count() const
+{
+    return workers.size() + 1;
+}
+
+size_t ThreadPool::hardware_threads()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::parallel_for(size_t count, size_t chunk, const RangeFunction & body)
+{
+    chunk = std::max<size_t>(chunk, 1);
+    if (workers.empty() || count <= chunk || inside_job)
+    {
+        body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        job = &body;
+        job_count = count;
+        job_chunk = chunk;
+        next_index.store(0, std::memory_order_relaxed);
+        busy_workers = workers.size();
+        job_error = nullptr;
+        ++generation;
+    }
+    start_condition.notify_all();
+
+    // help out instead of waiting idle
+    run_chunks();
+
+    std::unique_lock<std::mutex> lock{mutex};
+    done_condition.wait(lock, [this]{ return busy_workers == 0; });
+    job = nullptr;
+    if (job_error != nullptr)
+    {
+        std::exception_ptr error = job_error;
+        job_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::worker_loop()
+{
+    unsigned long long seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            start_condition.wait(lock, [&]{ return stopping || generation != seen_generation; });
+            if (stopping)
+            {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        run_chunks();
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            --busy_workers;
+        }
+        done_condition.notify_one();
+    }
+}
+
+void ThreadPool::run_chunks()
+{
+    inside_job = true;
+    try
+    {
+        while (true)
+        {
+            size_t begin = next_index.fetch_add(job_chunk, std::memory_order_relaxed);
+            if (begin >= job_count)
+            {
+                break;
+            }
+            (*job)(begin, std::min(begin + job_chunk, job_count));
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (job_error == nullptr)
+        {
+            job_error = std::current_exception();
+        }
+        // skip the remaining chunks
+        next_index.store(job_count, std::memory_order_relaxed);
+    }
+    inside_job = false;
+}
+
+} // namespace LCode
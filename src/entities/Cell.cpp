@@ -3,18 +3,39 @@
 #include "random.hpp"
 #include "sdl_math.hpp"
 #include "lilyutils.hpp"
+#include "LGlyphAtlas.hpp"
+#include "LTexture.hpp"
+#include "ShapeBatch.hpp"
+#include "NutrientField.hpp"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_gpu.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
 #define _USE_MATH_DEFINES
 #include <cmath>
+#include <cstdint>
 
 namespace LCode
 {
 
+const char * to_string(CellLod lod)
+{
+    switch (lod)
+    {
+    case CellLod::FULL:     return "full";
+    case CellLod::REDUCED:  return "reduced";
+    case CellLod::MINIMAL:  return "minimal";
+    case CellLod::COUNT:    break;
+    }
+    return "unknown";
+}
+
 Cell::Cell()
-: Cell(Game::get_random_screen_point())
+: Cell(Game::get_random_world_point())
 { }
 
 Cell::Cell(SDL_FPoint new_pos)
@@ -26,47 +47,62 @@ Cell::Cell(float x, float y)
   velocity{0.0f, 0.0f},
   color{rand_int<Uint8>(0x00, 0xFF), rand_int<Uint8>(0x00, 0xFF),
         rand_int<Uint8>(0x00, 0xFF), rand_int<Uint8>(0x88, 0xFF)},
-  radius{rand_int<Sint16>(16, 128)},
-  width{static_cast<Uint8>(sqrt(radius))},
+  radius{rand_int<Sint16>(MIN_RADIUS, MAX_RADIUS)},
+  width{static_cast<Uint8>(CellSpriteCache::get_outline_width(radius))},
   speed{rand_float(60.0f, 240.0f)}, draw_box{false},
-  life{rand_float(5.0, 20.0)}, life_total{life},
-  text_label{}
+  life{rand_float(5.0, 20.0)}, life_total{life}, lod{CellLod::FULL}
 {
     float angle = rand_float(0.0f, 2.0f * M_PI_F);
     velocity.x = std::cos(angle);
     velocity.y = std::sin(angle);
 }
 
-void Cell::update(double delta_ms)
-{
-    double delta_sec = delta_ms / 1000.0;
+Cell::Cell(const CellRecord & record)
+: LEntity(record.x, record.y),
+  velocity{record.velocity_x, record.velocity_y},
+  color{record.color}, radius{record.radius}, width{record.width},
+  speed{record.speed}, draw_box{record.draw_box != 0},
+  life{record.life}, life_total{record.life_total}, lod{CellLod::FULL}
+{ }
 
-    life -= delta_sec;
-    if (life <= 1.0 /*TODO: && color != BLACK*/)
+void Cell::update(const FrameContext & context)
+{
+    double delta_sec = context.delta_ms / 1000.0;
+    double life_before = life;
+    if (context.nutrients != nullptr)
     {
-        color = BLACK;
+        // feeding from the grid cell it is in, up to its starting life
+        const NutrientField & nutrients = *context.nutrients;
+        double fed = nutrients.feed(pos.x, pos.y, static_cast<float>(delta_sec))
+                     * nutrients.get_params().life_per_unit;
+        life = std::min(life + fed, life_total);
     }
+
+    life -= delta_sec;
     if (life <= 0.0)
     {
+        // all of its life leaves the total with it
+        ++context.tally->cell_deaths;
+        context.tally->life_change -= life_before;
         delete_self();
         return;
     }
+    context.tally->life_change += life - life_before;
 
     float step = speed * static_cast<float>(delta_sec);
-    const Uint8 * keystate = SDL_GetKeyboardState(nullptr);
-    if (keystate[SDL_SCANCODE_LSHIFT])
+    if (context.input.is_active(InputAction::SPEED_BOOST))
     {
         step *= 2;
     }
     pos.x += velocity.x * step;
     pos.y += velocity.y * step;
 
-    SDL_Rect window_rect = Game::get_instance()->get_window_rect();
+    const SDL_Rect & world_rect = context.world;
     // check X position
-    if (pos.x + radius > static_cast<float>(window_rect.w))
+    if (pos.x + radius > static_cast<float>(world_rect.w))
     {
         velocity = reflect(velocity, WEST);
-        pos.x = static_cast<float>(window_rect.w) - radius;
+        pos.x = static_cast<float>(world_rect.w) - radius;
     }
     else if (pos.x - radius < 0)
     {
@@ -74,10 +110,10 @@ void Cell::update(double delta_ms)
         pos.x = radius;
     }
     // check Y position
-    if (pos.y + radius > static_cast<float>(window_rect.h))
+    if (pos.y + radius > static_cast<float>(world_rect.h))
     {
         velocity = reflect(velocity, NORTH);
-        pos.y = static_cast<float>(window_rect.h) - radius;
+        pos.y = static_cast<float>(world_rect.h) - radius;
     }
     else if (pos.y - radius < 0)
     {
@@ -88,30 +124,159 @@ void Cell::update(double delta_ms)
 
 void Cell::draw(GPU_Target * gpu)
 {
+    ShapeBatch & batch = Game::get_instance()->get_shape_batch();
+    SDL_FPoint at = get_draw_pos();
+    float outer = static_cast<float>(radius);
+    lod = get_lod(outer * batch.get_scale());
+    count_lod(lod);
+    // about to die, until feeding brings it back
+    const SDL_Color & fill = life <= 1.0? BLACK : color;
+    if (lod == CellLod::MINIMAL)
+    {
+        // only a few pixels across, where a square looks the same as a circle
+        batch.add_rectangle(at.x - outer, at.y - outer, at.x + outer, at.y + outer, fill);
+        return;
+    }
     // draw a box!
-    if (draw_box)
+    if (draw_box && lod == CellLod::FULL)
     {
-        GPU_RectangleFilled(gpu, pos.x - radius, pos.y - radius,
-                                 pos.x + radius, pos.y + radius,
-                            SDL_Color{
-                                // use opposite color
-                                static_cast<Uint8>(0xFF - color.r),
-                                static_cast<Uint8>(0xFF - color.g),
-                                static_cast<Uint8>(0xFF - color.b),
-                                static_cast<Uint8>(color.a / 4)});
+        SDL_Color box_color{
+            // use opposite color
+            static_cast<Uint8>(0xFF - fill.r),
+            static_cast<Uint8>(0xFF - fill.g),
+            static_cast<Uint8>(0xFF - fill.b),
+            static_cast<Uint8>(fill.a / 4)};
+        if (render_mode == CellRenderMode::SPRITES)
+        {
+            // the batch is submitted after every sprite, so it would cover this one
+            GPU_RectangleFilled(gpu, at.x - outer, at.y - outer, at.x + outer, at.y + outer,
+                                box_color);
+        }
+        else
+        {
+            batch.add_rectangle(at.x - outer, at.y - outer, at.x + outer, at.y + outer,
+                                box_color);
+        }
     }
-    // draw a circle!
-    GPU_CircleFilled(gpu, pos.x, pos.y, radius, color);
-    // draw the black outline, `width` pixels wide
-    for (float ring = 0; ring < static_cast<float>(width); ring += 0.5f)
+    if (render_mode == CellRenderMode::SPRITES)
     {
-        GPU_Circle(gpu, pos.x, pos.y, radius - ring, BLACK);
+        // blit the pre-rendered circle and outline of this radius!
+        CellSpriteCache::get().draw(gpu, at.x, at.y, radius, fill, BLACK);
+        return;
     }
+    // draw a circle, inside the black outline that is `width` pixels wide!
+    float inner = outer - static_cast<float>(width);
+    batch.add_filled_circle(at.x, at.y, inner, fill);
+    batch.add_ring(at.x, at.y, inner, outer, BLACK);
+}
 
-    // load and render the text label!
-    text_label.load_text("HP: " + round_to(life, 1) + " / " + round_to(life_total, 1),
-                         life < 1.0? WHITE : BLACK);
-    text_label.render(pos.x - static_cast<float>(text_label.get_width())/2.0f, pos.y - static_cast<float>(text_label.get_height())/2.0f);
+std::uint64_t Cell::get_state_hash() const
+{
+    std::uint64_t hash = LEntity::get_state_hash();
+    hash = hash_combine(hash, velocity.x);
+    hash = hash_combine(hash, velocity.y);
+    hash = hash_combine(hash, life);
+    return hash_combine(hash, std::uint64_t{static_cast<Uint16>(radius)});
+}
+
+SDL_FRect Cell::get_bounds() const
+{
+    float size = 2.0f * static_cast<float>(radius);
+    return SDL_FRect{pos.x - static_cast<float>(radius), pos.y - static_cast<float>(radius),
+                     size, size};
+}
+
+float Cell::get_radius() const
+{
+    return static_cast<float>(radius);
+}
+
+double Cell::get_life() const
+{
+    return life;
+}
+
+CellRecord Cell::to_record() const
+{
+    CellRecord record;
+    record.x = pos.x;
+    record.y = pos.y;
+    record.velocity_x = velocity.x;
+    record.velocity_y = velocity.y;
+    record.life = life;
+    record.life_total = life_total;
+    record.speed = speed;
+    record.radius = radius;
+    record.width = width;
+    record.draw_box = draw_box;
+    record.color = color;
+    return record;
+}
+
+bool Cell::collide(Cell & other)
+{
+    return separate_circles(pos, velocity, get_radius(),
+                            other.pos, other.velocity, other.get_radius());
+}
+
+void Cell::set_render_mode(CellRenderMode mode)
+{
+    render_mode = mode;
+}
+
+CellRenderMode Cell::get_render_mode()
+{
+    return render_mode;
+}
+
+void Cell::set_lod_thresholds(const CellLodThresholds & thresholds)
+{
+    lod_thresholds = thresholds;
+    lod_thresholds.full_radius = std::max(thresholds.full_radius, thresholds.minimal_radius);
+}
+
+const CellLodThresholds & Cell::get_lod_thresholds()
+{
+    return lod_thresholds;
+}
+
+CellLod Cell::get_lod(float screen_radius)
+{
+    if (screen_radius >= lod_thresholds.full_radius)
+    {
+        return CellLod::FULL;
+    }
+    return screen_radius >= lod_thresholds.minimal_radius? CellLod::REDUCED : CellLod::MINIMAL;
+}
+
+void Cell::count_lod(CellLod level, size_t count)
+{
+    lod_counts[static_cast<size_t>(level)] += count;
+}
+
+const std::array<size_t, static_cast<size_t>(CellLod::COUNT)> & Cell::get_lod_counts()
+{
+    return lod_counts;
+}
+
+void Cell::reset_lod_counts()
+{
+    lod_counts.fill(0);
+}
+
+void Cell::draw_overlay(GPU_Target * gpu)
+{
+    // too small on screen to read
+    if (lod != CellLod::FULL)
+    {
+        return;
+    }
+    // render the text label from the font's glyph atlas!
+    SDL_FPoint at = get_draw_pos();
+    TextBuffer<LABEL_CAPACITY> label;
+    label.append("HP: ").append(life, 1).append(" / ").append(life_total, 1);
+    LGlyphAtlas::get(LTexture::get_fallback_font())
+        .draw_centered(gpu, label, at.x, at.y, life <= 1.0? WHITE : BLACK);
 }
 
 } // namespace LCode
@@ -0,0 +1,173 @@
+#include "entities/CellSpriteCache.hpp"
+#include "entities/Cell.hpp"
+#include "LException.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cmath>
+
+namespace LCode
+{
+// ---- Static initializers ----
+std::unique_ptr<CellSpriteCache> CellSpriteCache::instance{};
+
+// width of the atlas image, sprites wrap onto new shelves past this
+static const int ATLAS_WIDTH = 2048;
+
+const char * to_string(CellRenderMode mode)
+{
+    switch (mode)
+    {
+    case CellRenderMode::GEOMETRY:  return "geometry";
+    case CellRenderMode::SPRITES:   return "sprites";
+    }
+    return "unknown";
+}
+
+// How much of the pixel at `dist` from the center a circle of
+// `radius` covers, blended over one pixel for smooth edges.
+static float coverage(float dist, float radius)
+{
+    return std::clamp(radius - dist + 0.5f, 0.0f, 1.0f);
+}
+
+
+CellSpriteCache::CellSpriteCache(int min_r, int max_r)
+: image{nullptr}, fill_rects{}, outline_rects{},
+  min_radius{min_r}, max_radius{max_r}
+{
+    // shelf-pack both sprites of each radius, smallest first, with a pixel
+    // of margin so the anti-aliased edge isn't cut off
+    int x = 0, y = 0, shelf_height = 0;
+    auto place = [&](int size)
+    {
+        if (x + size > ATLAS_WIDTH)
+        {
+            x = 0;
+            y += shelf_height;
+            shelf_height = 0;
+        }
+        GPU_Rect rect{static_cast<float>(x), static_cast<float>(y),
+                      static_cast<float>(size), static_cast<float>(size)};
+        x += size;
+        shelf_height = std::max(shelf_height, size);
+        return rect;
+    };
+    for (int radius = min_radius; radius <= max_radius; ++radius)
+    {
+        int size = radius * 2 + 2;
+        fill_rects.push_back(place(size));
+        outline_rects.push_back(place(size));
+    }
+
+    SDL_Surface * surface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + shelf_height,
+                                                           32, SDL_PIXELFORMAT_RGBA32);
+    if (surface == nullptr)
+    {
+        throw LException{"Unable to create cell sprite surface! SDL Error: "
+                         + std::string{SDL_GetError()} + '\n'};
+    }
+    SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 0xFF, 0xFF, 0xFF, 0x00));
+
+    // white pixels, the shape is only in the alpha channel
+    SDL_LockSurface(surface);
+    Uint8 * pixels = static_cast<Uint8 *>(surface->pixels);
+    for (int radius = min_radius; radius <= max_radius; ++radius)
+    {
+        size_t index = static_cast<size_t>(radius - min_radius);
+        const GPU_Rect & fill = fill_rects[index];
+        const GPU_Rect & outline = outline_rects[index];
+        float outer = static_cast<float>(radius);
+        float inner = outer - static_cast<float>(get_outline_width(radius));
+        int size = radius * 2 + 2;
+        float center = static_cast<float>(size) / 2.0f;
+
+        for (int py = 0; py < size; ++py)
+        {
+            for (int px = 0; px < size; ++px)
+            {
+                float dx = static_cast<float>(px) + 0.5f - center;
+                float dy = static_cast<float>(py) + 0.5f - center;
+                float dist = std::sqrt(dx * dx + dy * dy);
+                float fill_alpha = coverage(dist, inner);
+                float outline_alpha = coverage(dist, outer) - fill_alpha;
+
+                Uint8 * fill_pixel = pixels + (static_cast<int>(fill.y) + py) * surface->pitch
+                                            + (static_cast<int>(fill.x) + px) * 4;
+                Uint8 * outline_pixel = pixels + (static_cast<int>(outline.y) + py) * surface->pitch
+                                               + (static_cast<int>(outline.x) + px) * 4;
+                fill_pixel[3] = static_cast<Uint8>(fill_alpha * 255.0f);
+                outline_pixel[3] = static_cast<Uint8>(outline_alpha * 255.0f);
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+
+    image = GPU_CopyImageFromSurface(surface);
+    SDL_FreeSurface(surface);
+    if (image == nullptr)
+    {
+        throw LException{"Unable to create cell sprite texture! SDL Error: "
+                         + std::string{SDL_GetError()} + '\n'};
+    }
+    // sprites are drawn at their native size
+    GPU_SetImageFilter(image, GPU_FILTER_NEAREST);
+}
+
+CellSpriteCache::~CellSpriteCache()
+{
+    if (image != nullptr)
+    {
+        GPU_FreeImage(image);
+        image = nullptr;
+    }
+}
+
+CellSpriteCache & CellSpriteCache::get()
+{
+    if (instance == nullptr)
+    {
+        instance = std::make_unique<CellSpriteCache>(Cell::MIN_RADIUS, Cell::MAX_RADIUS);
+    }
+    return *instance;
+}
+
+void CellSpriteCache::free()
+{
+    instance = nullptr;
+}
+
+int CellSpriteCache::get_outline_width(int radius)
+{
+    return static_cast<int>(std::sqrt(radius));
+}
+
+bool CellSpriteCache::has_radius(int radius) const
+{
+    return radius >= min_radius && radius <= max_radius;
+}
+
+void CellSpriteCache::draw(GPU_Target * gpu, float x, float y, int radius,
+                           SDL_Color fill_color, SDL_Color outline_color)
+{
+    radius = std::clamp(radius, min_radius, max_radius);
+    size_t index = static_cast<size_t>(radius - min_radius);
+    GPU_Rect fill = fill_rects[index];
+    GPU_Rect outline = outline_rects[index];
+    float half = fill.w / 2.0f;
+    GPU_Rect dest{x - half, y - half, fill.w, fill.h};
+
+    // the color is baked into each blit's vertices, so tinting
+    // between blits doesn't break SDL_gpu's batch
+    GPU_SetColor(image, fill_color);
+    GPU_BlitRect(image, &fill, gpu, &dest);
+    GPU_SetColor(image, outline_color);
+    GPU_BlitRect(image, &outline, gpu, &dest);
+}
+
+} // namespace LCode
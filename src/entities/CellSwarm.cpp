@@ -0,0 +1,665 @@
+#include "entities/CellSwarm.hpp"
+#include "SDLBaseGame.hpp"
+#include "ThreadPool.hpp"
+#include "ShapeBatch.hpp"
+#include "NutrientField.hpp"
+#include "entities/Cell.hpp"
+#include "entities/CellSpriteCache.hpp"
+#include "random.hpp"
+#include "sdl_math.hpp"
+#include "lilyutils.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_gpu.h>
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <numeric>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace LCode
+{
+
+#if defined(__AVX__)
+const char * const CellSwarm::SIMD_NAME = "AVX";
+#elif defined(__SSE2__)
+const char * const CellSwarm::SIMD_NAME = "SSE2";
+#else
+const char * const CellSwarm::SIMD_NAME = "scalar";
+#endif
+
+CellSwarm::CellSwarm()
+: LEntity(0.0f, 0.0f),
+  pos_x{}, pos_y{}, prev_x{}, prev_y{}, vel_x{}, vel_y{}, speeds{}, radii{},
+  lives{}, life_totals{}, colors{}, total_life{0.0},
+  dying{}, died{0}, chunk_dying{}, chunk_life{}, use_simd{true},
+  grid{2.0f * Cell::MAX_RADIUS}, grid_current{false}, collisions{false}, overlaps{0},
+  visible{}, visible_mask{}
+{ }
+
+CellSwarm::~CellSwarm() = default;
+
+void CellSwarm::add_cell(float x, float y)
+{
+    // same distributions as a new `Cell`
+    float angle = rand_float(0.0f, 2.0f * M_PI_F);
+    float life = rand_float(5.0f, 20.0f);
+    pos_x.push_back(x);
+    pos_y.push_back(y);
+    prev_x.push_back(x);
+    prev_y.push_back(y);
+    vel_x.push_back(std::cos(angle));
+    vel_y.push_back(std::sin(angle));
+    speeds.push_back(rand_float(60.0f, 240.0f));
+    radii.push_back(static_cast<float>(rand_int<Sint16>(Cell::MIN_RADIUS, Cell::MAX_RADIUS)));
+    lives.push_back(life);
+    life_totals.push_back(life);
+    total_life += life;
+    colors.push_back(SDL_Color{rand_int<Uint8>(0x00, 0xFF), rand_int<Uint8>(0x00, 0xFF),
+                               rand_int<Uint8>(0x00, 0xFF), rand_int<Uint8>(0x88, 0xFF)});
+    grid_current = false;
+}
+
+void CellSwarm::add_random_cells(size_t count)
+{
+    // `&pos_x[first]` below would index past the end
+    if (count == 0)
+    {
+        return;
+    }
+    // same distributions as `add_cell`, but every property is generated
+    // in bulk straight into its array
+    size_t first = size();
+    size_t new_size = first + count;
+    for (std::vector<float> * array : {&pos_x, &pos_y, &prev_x, &prev_y, &vel_x, &vel_y,
+                                       &speeds, &radii, &lives, &life_totals})
+    {
+        array->resize(new_size);
+    }
+    colors.resize(new_size);
+
+    const SDL_Rect & world_rect = SDLBaseGame::get_instance()->get_world_rect();
+    rand_floats(&pos_x[first], count, 0.0f, static_cast<float>(world_rect.w));
+    rand_floats(&pos_y[first], count, 0.0f, static_cast<float>(world_rect.h));
+    std::copy(pos_x.begin() + static_cast<std::ptrdiff_t>(first), pos_x.end(),
+              prev_x.begin() + static_cast<std::ptrdiff_t>(first));
+    std::copy(pos_y.begin() + static_cast<std::ptrdiff_t>(first), pos_y.end(),
+              prev_y.begin() + static_cast<std::ptrdiff_t>(first));
+
+    // directions go through vel_x until they are turned into vectors
+    rand_floats(&vel_x[first], count, 0.0f, 2.0f * M_PI_F);
+    for (size_t i = first; i < new_size; ++i)
+    {
+        float angle = vel_x[i];
+        vel_x[i] = std::cos(angle);
+        vel_y[i] = std::sin(angle);
+    }
+    rand_floats(&speeds[first], count, 60.0f, 240.0f);
+    rand_floats(&lives[first], count, 5.0f, 20.0f);
+    std::copy(lives.begin() + static_cast<std::ptrdiff_t>(first), lives.end(),
+              life_totals.begin() + static_cast<std::ptrdiff_t>(first));
+    total_life = std::accumulate(lives.begin() + static_cast<std::ptrdiff_t>(first),
+                                 lives.end(), total_life);
+
+    std::vector<Sint16> new_radii(count);
+    rand_ints(new_radii.data(), count, Cell::MIN_RADIUS, Cell::MAX_RADIUS);
+    std::copy(new_radii.begin(), new_radii.end(),
+              radii.begin() + static_cast<std::ptrdiff_t>(first));
+
+    std::vector<Uint8> channels(count * 3);
+    std::vector<Uint8> alphas(count);
+    rand_ints<Uint8>(channels.data(), channels.size(), 0x00, 0xFF);
+    rand_ints<Uint8>(alphas.data(), count, 0x88, 0xFF);
+    for (size_t i = 0; i < count; ++i)
+    {
+        colors[first + i] = SDL_Color{channels[i * 3], channels[i * 3 + 1],
+                                      channels[i * 3 + 2], alphas[i]};
+    }
+    grid_current = false;
+}
+
+size_t CellSwarm::size() const
+{
+    return lives.size();
+}
+
+std::uint64_t CellSwarm::get_died() const
+{
+    return died;
+}
+
+double CellSwarm::get_total_life() const
+{
+    return total_life;
+}
+
+void CellSwarm::save_snapshot(SnapshotWriter & writer) const
+{
+    for (const std::vector<float> * array : {&pos_x, &pos_y, &vel_x, &vel_y,
+                                             &speeds, &radii, &lives, &life_totals})
+    {
+        writer.write_array(array->data(), array->size());
+    }
+    writer.write_array(colors.data(), colors.size());
+}
+
+void CellSwarm::load_snapshot(SnapshotReader & reader, size_t count)
+{
+    for (std::vector<float> * array : {&pos_x, &pos_y, &vel_x, &vel_y,
+                                       &speeds, &radii, &lives, &life_totals})
+    {
+        array->resize(count);
+        reader.read_array(array->data(), count);
+    }
+    colors.resize(count);
+    reader.read_array(colors.data(), count);
+    prev_x = pos_x;
+    prev_y = pos_y;
+    total_life = std::accumulate(lives.begin(), lives.end(), 0.0);
+    dying.clear();
+    visible.clear();
+    grid_current = false;
+}
+
+void CellSwarm::set_simd(bool enabled)
+{
+    use_simd = enabled;
+}
+
+bool CellSwarm::is_simd() const
+{
+    return use_simd;
+}
+
+void CellSwarm::set_collisions(bool enabled)
+{
+    collisions = enabled;
+    overlaps = 0;
+}
+
+bool CellSwarm::has_collisions() const
+{
+    return collisions;
+}
+
+size_t CellSwarm::get_overlaps() const
+{
+    return overlaps;
+}
+
+size_t CellSwarm::get_drawn() const
+{
+    return visible.size();
+}
+
+void CellSwarm::update(const FrameContext & context)
+{
+    // cells per chunk handed to an update thread (a multiple of the SIMD width)
+    static const size_t CELL_CHUNK = 16384;
+
+    // the tick's input and world size, converted once for the whole swarm
+    StepParams params;
+    params.delta_sec = static_cast<float>(context.delta_ms / 1000.0);
+    params.step_scale = context.input.is_active(InputAction::SPEED_BOOST)? 2.0f : 1.0f;
+    params.world_w = static_cast<float>(context.world.w);
+    params.world_h = static_cast<float>(context.world.h);
+    params.nutrients = context.nutrients;
+
+    dying.clear();
+    ThreadPool * pool = SDLBaseGame::get_instance()->get_thread_pool();
+    if (pool == nullptr || size() < CELL_CHUNK * 2)
+    {
+        total_life = update_range(0, size(), params, dying);
+    }
+    else
+    {
+        // each chunk records its dying cells separately, then they are
+        // joined in chunk order so `dying` stays sorted
+        chunk_dying.resize((size() + CELL_CHUNK - 1) / CELL_CHUNK);
+        chunk_life.resize(chunk_dying.size());
+        for (std::vector<size_t> & chunk : chunk_dying)
+        {
+            chunk.clear();
+        }
+        pool->parallel_for(size(), CELL_CHUNK,
+            [this, &params](size_t begin, size_t end)
+            {
+                chunk_life[begin / CELL_CHUNK] = update_range(begin, end, params,
+                                                              chunk_dying[begin / CELL_CHUNK]);
+            });
+        for (const std::vector<size_t> & chunk : chunk_dying)
+        {
+            dying.insert(dying.end(), chunk.begin(), chunk.end());
+        }
+        total_life = std::accumulate(chunk_life.begin(), chunk_life.end(), 0.0);
+    }
+
+    remove_dead();
+    grid_current = false;
+    if (collisions)
+    {
+        resolve_overlaps();
+    }
+}
+
+double CellSwarm::update_range(size_t begin, size_t end, const StepParams & params,
+                               std::vector<size_t> & dying_out)
+{
+    if (params.nutrients != nullptr)
+    {
+        feed(begin, end, *params.nutrients, params.delta_sec);
+    }
+    // summed while the kernels have every life loaded anyway, so the
+    // total doesn't need a pass of its own
+    double life = 0.0;
+    size_t done = use_simd? update_simd(begin, end, params, dying_out, life) : begin;
+    update_scalar(done, end, params, dying_out, life);
+    return life;
+}
+
+void CellSwarm::feed(size_t begin, size_t end, const NutrientField & nutrients, float delta_sec)
+{
+    // a gather from the field per cell, so it stays scalar
+    const float life_per_unit = nutrients.get_params().life_per_unit;
+    for (size_t i = begin; i < end; ++i)
+    {
+        float fed = nutrients.feed(pos_x[i], pos_y[i], delta_sec) * life_per_unit;
+        lives[i] = std::min(lives[i] + fed, life_totals[i]);
+    }
+}
+
+void CellSwarm::add_demand_to(NutrientField & nutrients) const
+{
+    for (size_t i = 0; i < size(); ++i)
+    {
+        nutrients.add_demand(pos_x[i], pos_y[i]);
+    }
+}
+
+void CellSwarm::update_scalar(size_t begin, size_t end, const StepParams & params,
+                              std::vector<size_t> & dying_out, double & life_out)
+{
+    const float delta_sec = params.delta_sec;
+    const float world_w = params.world_w;
+    const float world_h = params.world_h;
+    // Reflecting off an axis-aligned wall (`reflect()` with EAST, WEST,
+    // NORTH or SOUTH) only negates one component of the velocity.
+    for (size_t i = begin; i < end; ++i)
+    {
+        lives[i] -= delta_sec;
+        life_out += lives[i];
+        if (lives[i] <= 0.0f)
+        {
+            dying_out.push_back(i);
+        }
+
+        float step = speeds[i] * delta_sec * params.step_scale;
+        pos_x[i] += vel_x[i] * step;
+        pos_y[i] += vel_y[i] * step;
+
+        float radius = radii[i];
+        // check X position
+        if (pos_x[i] + radius > world_w)
+        {
+            vel_x[i] = -vel_x[i];
+            pos_x[i] = world_w - radius;
+        }
+        else if (pos_x[i] - radius < 0)
+        {
+            vel_x[i] = -vel_x[i];
+            pos_x[i] = radius;
+        }
+        // check Y position
+        if (pos_y[i] + radius > world_h)
+        {
+            vel_y[i] = -vel_y[i];
+            pos_y[i] = world_h - radius;
+        }
+        else if (pos_y[i] - radius < 0)
+        {
+            vel_y[i] = -vel_y[i];
+            pos_y[i] = radius;
+        }
+    }
+}
+
+size_t CellSwarm::update_simd(size_t begin, size_t end, const StepParams & params,
+                              std::vector<size_t> & dying_out, double & life_out)
+{
+    const float delta_sec = params.delta_sec;
+    const float step_scale = params.step_scale;
+    const float world_w = params.world_w;
+    const float world_h = params.world_h;
+    size_t i = begin;
+#if defined(__AVX__)
+    const __m256 dt = _mm256_set1_ps(delta_sec);
+    const __m256 step_dt = _mm256_set1_ps(delta_sec * step_scale);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    const __m256 max_x = _mm256_set1_ps(world_w);
+    const __m256 max_y = _mm256_set1_ps(world_h);
+    // added up as doubles, like the scalar kernel does
+    __m256d life_sum = _mm256_setzero_pd();
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 life = _mm256_sub_ps(_mm256_loadu_ps(&lives[i]), dt);
+        _mm256_storeu_ps(&lives[i], life);
+        life_sum = _mm256_add_pd(life_sum, _mm256_cvtps_pd(_mm256_castps256_ps128(life)));
+        life_sum = _mm256_add_pd(life_sum, _mm256_cvtps_pd(_mm256_extractf128_ps(life, 1)));
+        record_dying(dying_out, i, _mm256_movemask_ps(_mm256_cmp_ps(life, zero, _CMP_LE_OQ)));
+
+        __m256 step = _mm256_mul_ps(_mm256_loadu_ps(&speeds[i]), step_dt);
+        __m256 radius = _mm256_loadu_ps(&radii[i]);
+        __m256 vx = _mm256_loadu_ps(&vel_x[i]);
+        __m256 vy = _mm256_loadu_ps(&vel_y[i]);
+        __m256 px = _mm256_add_ps(_mm256_loadu_ps(&pos_x[i]), _mm256_mul_ps(vx, step));
+        __m256 py = _mm256_add_ps(_mm256_loadu_ps(&pos_y[i]), _mm256_mul_ps(vy, step));
+
+        // check X position
+        __m256 hit_max = _mm256_cmp_ps(_mm256_add_ps(px, radius), max_x, _CMP_GT_OQ);
+        __m256 hit_min = _mm256_andnot_ps(hit_max,
+                _mm256_cmp_ps(_mm256_sub_ps(px, radius), zero, _CMP_LT_OQ));
+        vx = _mm256_xor_ps(vx, _mm256_and_ps(_mm256_or_ps(hit_max, hit_min), sign_bit));
+        px = _mm256_blendv_ps(px, _mm256_sub_ps(max_x, radius), hit_max);
+        px = _mm256_blendv_ps(px, radius, hit_min);
+        // check Y position
+        hit_max = _mm256_cmp_ps(_mm256_add_ps(py, radius), max_y, _CMP_GT_OQ);
+        hit_min = _mm256_andnot_ps(hit_max,
+                _mm256_cmp_ps(_mm256_sub_ps(py, radius), zero, _CMP_LT_OQ));
+        vy = _mm256_xor_ps(vy, _mm256_and_ps(_mm256_or_ps(hit_max, hit_min), sign_bit));
+        py = _mm256_blendv_ps(py, _mm256_sub_ps(max_y, radius), hit_max);
+        py = _mm256_blendv_ps(py, radius, hit_min);
+
+        _mm256_storeu_ps(&vel_x[i], vx);
+        _mm256_storeu_ps(&vel_y[i], vy);
+        _mm256_storeu_ps(&pos_x[i], px);
+        _mm256_storeu_ps(&pos_y[i], py);
+    }
+    alignas(32) double life_lanes[4];
+    _mm256_store_pd(life_lanes, life_sum);
+    life_out += (life_lanes[0] + life_lanes[1]) + (life_lanes[2] + life_lanes[3]);
+#elif defined(__SSE2__)
+    const __m128 dt = _mm_set1_ps(delta_sec);
+    const __m128 step_dt = _mm_set1_ps(delta_sec * step_scale);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 sign_bit = _mm_set1_ps(-0.0f);
+    const __m128 max_x = _mm_set1_ps(world_w);
+    const __m128 max_y = _mm_set1_ps(world_h);
+    // SSE2 has no blend, select b where mask is set and a elsewhere
+    auto select = [](__m128 a, __m128 b, __m128 mask)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+    };
+
+    // added up as doubles, like the scalar kernel does
+    __m128d life_sum = _mm_setzero_pd();
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 life = _mm_sub_ps(_mm_loadu_ps(&lives[i]), dt);
+        _mm_storeu_ps(&lives[i], life);
+        life_sum = _mm_add_pd(life_sum, _mm_cvtps_pd(life));
+        life_sum = _mm_add_pd(life_sum, _mm_cvtps_pd(_mm_movehl_ps(life, life)));
+        record_dying(dying_out, i, _mm_movemask_ps(_mm_cmple_ps(life, zero)));
+
+        __m128 step = _mm_mul_ps(_mm_loadu_ps(&speeds[i]), step_dt);
+        __m128 radius = _mm_loadu_ps(&radii[i]);
+        __m128 vx = _mm_loadu_ps(&vel_x[i]);
+        __m128 vy = _mm_loadu_ps(&vel_y[i]);
+        __m128 px = _mm_add_ps(_mm_loadu_ps(&pos_x[i]), _mm_mul_ps(vx, step));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(&pos_y[i]), _mm_mul_ps(vy, step));
+
+        // check X position
+        __m128 hit_max = _mm_cmpgt_ps(_mm_add_ps(px, radius), max_x);
+        __m128 hit_min = _mm_andnot_ps(hit_max, _mm_cmplt_ps(_mm_sub_ps(px, radius), zero));
+        vx = _mm_xor_ps(vx, _mm_and_ps(_mm_or_ps(hit_max, hit_min), sign_bit));
+        px = select(px, _mm_sub_ps(max_x, radius), hit_max);
+        px = select(px, radius, hit_min);
+        // check Y position
+        hit_max = _mm_cmpgt_ps(_mm_add_ps(py, radius), max_y);
+        hit_min = _mm_andnot_ps(hit_max, _mm_cmplt_ps(_mm_sub_ps(py, radius), zero));
+        vy = _mm_xor_ps(vy, _mm_and_ps(_mm_or_ps(hit_max, hit_min), sign_bit));
+        py = select(py, _mm_sub_ps(max_y, radius), hit_max);
+        py = select(py, radius, hit_min);
+
+        _mm_storeu_ps(&vel_x[i], vx);
+        _mm_storeu_ps(&vel_y[i], vy);
+        _mm_storeu_ps(&pos_x[i], px);
+        _mm_storeu_ps(&pos_y[i], py);
+    }
+    alignas(16) double life_lanes[2];
+    _mm_store_pd(life_lanes, life_sum);
+    life_out += life_lanes[0] + life_lanes[1];
+#else
+    // no SIMD available, everything is left for `update_scalar`
+    (void) end; (void) delta_sec; (void) step_scale; (void) world_w; (void) world_h;
+    (void) dying_out; (void) life_out;
+#endif
+    return i;
+}
+
+void CellSwarm::record_dying(std::vector<size_t> & dying_out, size_t first, int lane_mask)
+{
+    // usually no lane is dying, so this is one well-predicted branch
+    for (size_t lane = 0; lane_mask != 0; ++lane, lane_mask >>= 1)
+    {
+        if (lane_mask & 1)
+        {
+            dying_out.push_back(first + lane);
+        }
+    }
+}
+
+void CellSwarm::remove_dead()
+{
+    // Indices were recorded in ascending order, so walking them backwards
+    // means every cell swapped into a removed slot was already handled.
+    for (size_t d = dying.size(); d > 0; --d)
+    {
+        size_t i = dying[d - 1];
+        // its life left (at most 0) leaves the total with it
+        total_life -= lives[i];
+        remove_cell(i);
+        ++died;
+    }
+}
+
+void CellSwarm::remove_cell(size_t index)
+{
+    for (std::vector<float> * array : {&pos_x, &pos_y, &prev_x, &prev_y, &vel_x, &vel_y,
+                                       &speeds, &radii, &lives, &life_totals})
+    {
+        (*array)[index] = array->back();
+        array->pop_back();
+    }
+    colors[index] = colors.back();
+    colors.pop_back();
+}
+
+void CellSwarm::resolve_overlaps()
+{
+    update_grid();
+
+    // Pairs share cells, so this runs on one thread. Positions pushed
+    // earlier in the pass aren't re-bucketed until the next update.
+    // The arrays are read through local pointers so they stay in registers.
+    float * px = pos_x.data();
+    float * py = pos_y.data();
+    float * vx = vel_x.data();
+    float * vy = vel_y.data();
+    const float * radius = radii.data();
+    size_t separated = 0;
+    grid.for_each_pair([&](size_t a, size_t b)
+    {
+        // most candidate pairs are apart, reject them straight from the arrays
+        float dx = px[b] - px[a], dy = py[b] - py[a];
+        float reach = radius[a] + radius[b];
+        if (dx * dx + dy * dy >= reach * reach)
+        {
+            return;
+        }
+        SDL_FPoint pos_a{px[a], py[a]}, dir_a{vx[a], vy[a]};
+        SDL_FPoint pos_b{px[b], py[b]}, dir_b{vx[b], vy[b]};
+        separate_circles(pos_a, dir_a, radius[a], pos_b, dir_b, radius[b]);
+        px[a] = pos_a.x; py[a] = pos_a.y;
+        vx[a] = dir_a.x; vy[a] = dir_a.y;
+        px[b] = pos_b.x; py[b] = pos_b.y;
+        vx[b] = dir_b.x; vy[b] = dir_b.y;
+        ++separated;
+    });
+    overlaps = separated;
+    grid_current = separated == 0;
+}
+
+void CellSwarm::update_grid()
+{
+    if (grid_current)
+    {
+        return;
+    }
+    const SDL_Rect & world_rect = SDLBaseGame::get_instance()->get_world_rect();
+    grid.build(pos_x.data(), pos_y.data(), size(),
+               static_cast<float>(world_rect.w), static_cast<float>(world_rect.h));
+    grid_current = true;
+}
+
+void CellSwarm::find_visible(const SDL_FRect & view)
+{
+    visible.clear();
+    const SDL_Rect & world_rect = SDLBaseGame::get_instance()->get_world_rect();
+    if (view.x <= 0.0f && view.y <= 0.0f
+        && view.x + view.w >= static_cast<float>(world_rect.w)
+        && view.y + view.h >= static_cast<float>(world_rect.h))
+    {
+        // the whole world is in view, no need to look anything up
+        visible.resize(size());
+        std::iota(visible.begin(), visible.end(), size_t{0});
+        return;
+    }
+
+    update_grid();
+    float left = view.x, top = view.y;
+    float right = view.x + view.w, bottom = view.y + view.h;
+    // cells are found bucket by bucket, marking them keeps the draw order
+    visible_mask.assign(size(), 0);
+    grid.query_rect(left - Cell::MAX_RADIUS, top - Cell::MAX_RADIUS,
+                    right + Cell::MAX_RADIUS, bottom + Cell::MAX_RADIUS,
+        [&](size_t i)
+        {
+            float radius = radii[i];
+            visible_mask[i] = pos_x[i] + radius >= left && pos_x[i] - radius <= right
+                              && pos_y[i] + radius >= top && pos_y[i] - radius <= bottom;
+        });
+    for (size_t i = 0; i < size(); ++i)
+    {
+        if (visible_mask[i])
+        {
+            visible.push_back(i);
+        }
+    }
+}
+
+void CellSwarm::save_previous_state()
+{
+    prev_x = pos_x;
+    prev_y = pos_y;
+}
+
+std::uint64_t CellSwarm::get_state_hash() const
+{
+    std::uint64_t hash = hash_combine(LEntity::get_state_hash(), std::uint64_t{size()});
+    for (const std::vector<float> * array : {&pos_x, &pos_y, &vel_x, &vel_y, &lives})
+    {
+        for (float value : *array)
+        {
+            hash = hash_combine(hash, value);
+        }
+    }
+    return hash;
+}
+
+SDL_FRect CellSwarm::get_bounds() const
+{
+    const SDL_Rect & world_rect = SDLBaseGame::get_instance()->get_world_rect();
+    return SDL_FRect{0.0f, 0.0f, static_cast<float>(world_rect.w),
+                     static_cast<float>(world_rect.h)};
+}
+
+bool CellSwarm::splits_own_update() const
+{
+    return true;
+}
+
+void CellSwarm::draw(GPU_Target * gpu)
+{
+    SDLBaseGame * game = SDLBaseGame::get_instance();
+    if (game->is_culling())
+    {
+        SDL_FRect view = game->get_camera().get_view();
+        find_visible(SDL_FRect{view.x - SDLBaseGame::CULL_MARGIN,
+                               view.y - SDLBaseGame::CULL_MARGIN,
+                               view.w + 2.0f * SDLBaseGame::CULL_MARGIN,
+                               view.h + 2.0f * SDLBaseGame::CULL_MARGIN});
+    }
+    else
+    {
+        visible.resize(size());
+        std::iota(visible.begin(), visible.end(), size_t{0});
+    }
+
+    float alpha = static_cast<float>(game->get_interpolation_alpha());
+    // blend from the position before the latest tick
+    auto draw_x = [&](size_t i) { return prev_x[i] + (pos_x[i] - prev_x[i]) * alpha; };
+    auto draw_y = [&](size_t i) { return prev_y[i] + (pos_y[i] - prev_y[i]) * alpha; };
+
+    // swarm cells skip the label to stay cheap at scale, so FULL and REDUCED
+    // only differ in how many segments the batch gives each circle
+    ShapeBatch & batch = game->get_shape_batch();
+    CellSpriteCache & sprites = CellSpriteCache::get();
+    bool use_sprites = Cell::get_render_mode() == CellRenderMode::SPRITES;
+    float scale = batch.get_scale();
+    std::array<size_t, static_cast<size_t>(CellLod::COUNT)> counts{};
+    for (size_t i : visible)
+    {
+        float x = draw_x(i);
+        float y = draw_y(i);
+        CellLod lod = Cell::get_lod(radii[i] * scale);
+        ++counts[static_cast<size_t>(lod)];
+        // cells about to die are black, until feeding brings them back
+        const SDL_Color & fill = lives[i] <= 1.0f? BLACK : colors[i];
+        if (lod == CellLod::MINIMAL)
+        {
+            batch.add_rectangle(x - radii[i], y - radii[i], x + radii[i], y + radii[i], fill);
+        }
+        else if (use_sprites)
+        {
+            sprites.draw(gpu, x, y, static_cast<int>(radii[i]), fill, BLACK);
+        }
+        else
+        {
+            float inner = radii[i] - static_cast<float>(
+                    CellSpriteCache::get_outline_width(static_cast<int>(radii[i])));
+            batch.add_filled_circle(x, y, inner, fill);
+            batch.add_ring(x, y, inner, radii[i], BLACK);
+        }
+    }
+    for (size_t tier = 0; tier < counts.size(); ++tier)
+    {
+        Cell::count_lod(static_cast<CellLod>(tier), counts[tier]);
+    }
+}
+
+} // namespace LCode
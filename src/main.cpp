@@ -1,10 +1,432 @@
 #include "Game.hpp"
+#include "headless.hpp"
+#include "LException.hpp"
+#include "ThreadPool.hpp"
+#include "Replay.hpp"
+#include "LTimer.hpp"
+#include "Telemetry.hpp"
+#include "lilyutils.hpp"
+#include "random.hpp"
 
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
 
-int main()
+static void print_usage(const char * program)
 {
+    std::cout << "Usage: " << program << " [--headless] [--frames N] [--seconds S]"
+                                         " [--delta MS] [--cells N] [--swarm N]\n"
+                 "       [--scalar] [--threads N] [--scaling] [--sprites]\n"
+                 "       [--tick-rate HZ] [--max-ticks N] [--fps N] [--vsync]\n"
+                 "       [--profile-csv FILE] [--seed N] [--record FILE]\n"
+                 "       [--replay FILE] [--collide] [--world WxH]\n"
+                 "       [--lod-full PX] [--lod-minimal PX] [--load FILE] [--save FILE]\n"
+                 "       [--telemetry FILE] [--nutrients]\n"
+              << "  --headless   simulate without a window or GPU and print a report\n"
+              << "  --frames N   (headless) stop after N update steps\n"
+              << "  --seconds S  (headless) stop after S simulated seconds\n"
+              << "  --delta MS   (headless) fixed delta per step, default is wall-clock\n"
+              << "  --cells N    number of cells to spawn at startup (default 1)\n"
+              << "  --swarm N    number of structure-of-arrays swarm cells to spawn\n"
+              << "  --scalar     update the swarm and nutrient field without\n"
+              << "               SIMD, for comparison\n"
+              << "  --threads N  threads to update entities with (default: all)\n"
+              << "  --scaling    (headless) repeat the run with 1..N threads and\n"
+              << "               print the speedup of each\n"
+              << "  --sprites    start drawing cells from the sprite cache\n"
+              << "  --tick-rate HZ  fixed simulation ticks per second (default 60)\n"
+              << "  --max-ticks N   most ticks simulated per frame before slowing\n"
+              << "                  down to catch up (default 5)\n"
+              << "  --fps N      frames per second to pace drawing to, 0 for\n"
+              << "               unlimited (default 60)\n"
+              << "  --vsync      wait for the display refresh every frame\n"
+              << "  --profile-csv FILE  write the per-phase times of the last\n"
+              << "                      frames to FILE on exit\n"
+              << "  --seed N     random seed to start the game with\n"
+              << "  --record FILE  log the seed, frame times and key presses of\n"
+              << "                 this windowed run to FILE\n"
+              << "  --replay FILE  reproduce a recorded run (add --headless to\n"
+              << "                 skip drawing) and verify its final checksum\n"
+              << "  --collide    push overlapping cells apart\n"
+              << "  --world WxH  simulate cells in a world of W by H pixels\n"
+              << "               instead of the window (e.g. 20000x20000)\n"
+              << "  --lod-full PX     on-screen radius cells get their label and\n"
+              << "                    box from (default 24)\n"
+              << "  --lod-minimal PX  on-screen radius cells are drawn as plain\n"
+              << "                    squares below (default 3)\n"
+              << "  --load FILE  start from the cells saved in snapshot FILE\n"
+              << "               instead of spawning them\n"
+              << "  --save FILE  save a snapshot of every cell to FILE on exit\n"
+              << "  --telemetry FILE  write population stats of every frame to\n"
+              << "                    FILE (CSV if it ends in .csv, else binary)\n"
+              << "  --nutrients  cells feed from a diffusing nutrient field to\n"
+              << "               stay alive instead of only counting down\n";
+}
+
+// Saves a snapshot of `game` to `path` and reports how long it took.
+static void save_game_snapshot(const LCode::Game & game, const std::string & path)
+{
+    LCode::LTimer timer;
+    timer.start();
+    size_t saved = game.save_snapshot(path);
+    std::cout << "snapshot:      " << saved << " cells saved to " << path << " in "
+              << LCode::round_to(timer.get_ms(), 1) << " ms\n";
+}
+
+// Files a run writes besides its report, each empty to skip it.
+struct OutputPaths
+{
+    std::string profile_csv{};
+    std::string snapshot{};
+    std::string telemetry{};
+};
+
+// Starts exporting telemetry from `game` if `outputs` asks for it.
+static std::unique_ptr<LCode::TelemetryWriter> start_telemetry(LCode::Game & game,
+                                                               const OutputPaths & outputs)
+{
+    if (outputs.telemetry.empty())
+    {
+        return nullptr;
+    }
+    std::unique_ptr<LCode::TelemetryWriter> telemetry;
+    try
+    {
+        telemetry = std::make_unique<LCode::TelemetryWriter>(
+                outputs.telemetry, LCode::TelemetryWriter::format_for(outputs.telemetry));
+    }
+    catch (const LCode::LException & e)
+    {
+        // like an unwritable --profile-csv, the run goes on without it
+        std::cerr << e.what() << " Running without telemetry.\n";
+        return nullptr;
+    }
+    game.set_telemetry(telemetry.get());
+    return telemetry;
+}
+
+// Writes the rest of `outputs` once `game` stopped running.
+static void finish_outputs(LCode::Game & game, const OutputPaths & outputs,
+                           LCode::TelemetryWriter * telemetry)
+{
+    if (telemetry != nullptr)
+    {
+        game.set_telemetry(nullptr);
+        telemetry->close();
+        std::cout << *telemetry;
+    }
+    if (!outputs.profile_csv.empty())
+    {
+        game.get_profiler().write_csv(outputs.profile_csv);
+    }
+    if (!outputs.snapshot.empty())
+    {
+        save_game_snapshot(game, outputs.snapshot);
+    }
+}
+
+// Replays a recording, starting the game the way the recording did.
+static int run_replay_game(LCode::GameOptions options, const std::string & path)
+{
+    LCode::ReplayReader reader{path};
+    const LCode::ReplayHeader & header = reader.get_header();
+    options.seed = header.seed;
+    options.tick_rate = header.tick_rate;
+    options.max_ticks_per_frame = header.max_ticks_per_frame;
+    options.cells = static_cast<size_t>(header.cells);
+    options.swarm_cells = static_cast<size_t>(header.swarm_cells);
+    options.start_paused = header.start_paused != 0;
+    options.collisions = header.collisions != 0;
+    options.nutrients = header.nutrients != 0;
+    options.world_width = header.world_width;
+    options.world_height = header.world_height;
+
+    LCode::Game game{options};
+    game.set_swarm_simd(header.scalar == 0);
+    game.get_nutrients().set_simd(header.scalar == 0);
+    if (game.get_state_checksum() != header.start_checksum)
+    {
+        std::cerr << "Warning: the replayed game starts in a different state than the "
+                     "recording, was it recorded on a screen of another size ("
+                  << header.screen_width << "x" << header.screen_height << ")?\n";
+    }
+    LCode::ReplayResult result = game.run_replay(reader);
+    std::cout << result;
+    return result.matches()? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Runs one headless game and prints its report.
+static LCode::HeadlessReport run_headless_game(const LCode::GameOptions & options,
+                                               const LCode::HeadlessConfig & config,
+                                               bool scalar,
+                                               const OutputPaths & outputs = OutputPaths{})
+{
+    LCode::Game game{options};                  // no window
+    game.set_swarm_simd(!scalar);
+    game.get_nutrients().set_simd(!scalar);
+    size_t swarm_start = game.get_swarm_size();
+    std::unique_ptr<LCode::TelemetryWriter> telemetry = start_telemetry(game, outputs);
+    LCode::HeadlessReport report = game.run_headless(config);   // simulate only
+    std::cout << report
+              << "swarm cells:   " << swarm_start << " -> " << game.get_swarm_size()
+              << " (" << (scalar? "scalar" : LCode::CellSwarm::SIMD_NAME) << ")\n";
+    if (game.has_collisions())
+    {
+        std::cout << "overlaps:      " << game.get_overlaps() << " (last step)\n";
+    }
+    if (game.has_nutrients())
+    {
+        const LCode::NutrientField & nutrients = game.get_nutrients();
+        std::cout << "nutrients:     mean " << LCode::round_to(nutrients.get_mean_level(), 3)
+                  << " over " << nutrients.get_columns() << "x" << nutrients.get_rows()
+                  << " grid (" << (scalar? "scalar" : LCode::NutrientField::SIMD_NAME) << ")\n";
+    }
+    std::cout << game.get_entity_pool();
+    finish_outputs(game, outputs, telemetry.get());
+    return report;
+}
+
+// Runs the same headless workload with 1..N update threads.
+static void run_scaling(LCode::GameOptions options, const LCode::HeadlessConfig & config,
+                        bool scalar)
+{
+    size_t max_threads = options.update_threads > 0? options.update_threads
+                                                   : LCode::ThreadPool::hardware_threads();
+    std::vector<double> steps_per_sec;
+    for (size_t threads = 1; threads <= max_threads; ++threads)
+    {
+        std::cout << "---- " << threads << " thread(s) ----\n";
+        options.update_threads = threads;
+        steps_per_sec.push_back(run_headless_game(options, config, scalar).steps_per_sec);
+    }
+
+    std::cout << "---- scaling ----\nthreads, steps/sec, speedup\n";
+    for (size_t i = 0; i < steps_per_sec.size(); ++i)
+    {
+        std::cout << i + 1 << ", " << steps_per_sec[i] << ", "
+                  << steps_per_sec[i] / steps_per_sec[0] << "\n";
+    }
+}
+
+// Runs the game in a window until it's closed, recording it to `record_path`
+// unless that's empty.
+static int run_windowed_game(LCode::GameOptions options, bool scalar,
+                             const std::string & record_path, const OutputPaths & outputs)
+{
+    if (!record_path.empty() && !options.seed)
+    {
+        // the seed has to be known to be recorded
+        LCode::seed_rand();
+        options.seed = LCode::get_rand_seed();
+    }
+    LCode::Game game{options};   // initialize window
+    game.set_swarm_simd(!scalar);
+    game.get_nutrients().set_simd(!scalar);
+    std::unique_ptr<LCode::ReplayWriter> recorder;
+    if (!record_path.empty())
+    {
+        LCode::ReplayHeader header;
+        header.seed = *options.seed;
+        header.tick_rate = game.get_tick_rate();
+        header.max_ticks_per_frame = options.max_ticks_per_frame;
+        header.screen_width = game.get_window_rect().w;
+        header.screen_height = game.get_window_rect().h;
+        header.cells = options.cells;
+        header.swarm_cells = options.swarm_cells;
+        header.start_paused = game.is_paused();
+        header.collisions = game.has_collisions();
+        header.nutrients = game.has_nutrients();
+        header.scalar = scalar;
+        header.world_width = options.world_width;
+        header.world_height = options.world_height;
+        header.start_checksum = game.get_state_checksum();
+        recorder = std::make_unique<LCode::ReplayWriter>(record_path, header);
+        game.set_recorder(recorder.get());
+    }
+    std::unique_ptr<LCode::TelemetryWriter> telemetry = start_telemetry(game, outputs);
+    int result = game.run();     // run loop
+    std::cout << game.get_frame_pacer().get_stats();
+    finish_outputs(game, outputs, telemetry.get());
+    return result;
+}
+
+int main(int argc, char * argv[])
+{
+    LCode::GameOptions options;
+    LCode::HeadlessConfig config;
+    bool scalar = false;
+    bool scaling = false;
+    OutputPaths outputs;
+    std::string record_path;
+    std::string replay_path;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg{argv[i]};
+        bool has_value = i + 1 < argc;
+        if (arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if (arg == "--frames" && has_value)
+        {
+            config.max_frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seconds" && has_value)
+        {
+            config.max_sim_seconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--delta" && has_value)
+        {
+            config.fixed_delta_ms = std::atof(argv[++i]);
+        }
+        else if (arg == "--cells" && has_value)
+        {
+            options.cells = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else if (arg == "--swarm" && has_value)
+        {
+            options.swarm_cells = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else if (arg == "--scalar")
+        {
+            scalar = true;
+        }
+        else if (arg == "--threads" && has_value)
+        {
+            options.update_threads = static_cast<size_t>(std::atol(argv[++i]));
+        }
+        else if (arg == "--scaling")
+        {
+            scaling = true;
+        }
+        else if (arg == "--sprites")
+        {
+            options.render_mode = LCode::CellRenderMode::SPRITES;
+        }
+        else if (arg == "--tick-rate" && has_value)
+        {
+            options.tick_rate = std::atof(argv[++i]);
+        }
+        else if (arg == "--max-ticks" && has_value)
+        {
+            options.max_ticks_per_frame = std::atoi(argv[++i]);
+        }
+        else if (arg == "--fps" && has_value)
+        {
+            options.target_fps = std::atof(argv[++i]);
+        }
+        else if (arg == "--vsync")
+        {
+            options.vsync = true;
+        }
+        else if (arg == "--profile-csv" && has_value)
+        {
+            outputs.profile_csv = argv[++i];
+        }
+        else if (arg == "--seed" && has_value)
+        {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--record" && has_value)
+        {
+            record_path = argv[++i];
+        }
+        else if (arg == "--replay" && has_value)
+        {
+            replay_path = argv[++i];
+        }
+        else if (arg == "--collide")
+        {
+            options.collisions = true;
+        }
+        else if (arg == "--nutrients")
+        {
+            options.nutrients = true;
+        }
+        else if (arg == "--world" && has_value)
+        {
+            // WxH, e.g. 20000x20000
+            char * height = nullptr;
+            options.world_width = static_cast<int>(std::strtol(argv[++i], &height, 10));
+            options.world_height = *height == 'x'? std::atoi(height + 1) : 0;
+            if (options.world_width <= 0 || options.world_height <= 0)
+            {
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (arg == "--load" && has_value)
+        {
+            options.snapshot = argv[++i];
+        }
+        else if (arg == "--save" && has_value)
+        {
+            outputs.snapshot = argv[++i];
+        }
+        else if (arg == "--telemetry" && has_value)
+        {
+            outputs.telemetry = argv[++i];
+        }
+        else if (arg == "--lod-full" && has_value)
+        {
+            options.lod.full_radius = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--lod-minimal" && has_value)
+        {
+            options.lod.minimal_radius = static_cast<float>(std::atof(argv[++i]));
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!record_path.empty() && (options.headless || !replay_path.empty()))
+    {
+        std::cerr << "--record only records windowed runs!\n";
+        return EXIT_FAILURE;
+    }
+    if (!options.snapshot.empty() && (!record_path.empty() || !replay_path.empty()))
+    {
+        // recordings start from their seed and options, not from a file
+        std::cerr << "--load can't be combined with --record or --replay!\n";
+        return EXIT_FAILURE;
+    }
+
     std::cout << "Hello!\n";
-    LCode::Game game;   // initialize window
-    return game.run();  // run loop
-}
\ No newline at end of file
+    try
+    {
+        if (!replay_path.empty())
+        {
+            return run_replay_game(options, replay_path);
+        }
+        if (options.headless)
+        {
+            if (config.max_frames <= 0 && config.max_sim_seconds <= 0.0)
+            {
+                config.max_frames = 1000;
+            }
+            if (scaling)
+            {
+                run_scaling(options, config, scalar);
+            }
+            else
+            {
+                run_headless_game(options, config, scalar, outputs);
+            }
+            return EXIT_SUCCESS;
+        }
+        return run_windowed_game(options, scalar, record_path, outputs);
+    }
+    catch (const LCode::LException & e)
+    {
+        // unreadable or unwritable files, or SDL failing to start
+        std::cerr << "Error: " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,36 @@
+#include "random.hpp"
+
+#include <chrono>       // high_resolution_clock, to seed from the time
+#include <cstdint>
+#include <ctime>        // time()
+
+namespace LCode
+{
+
+void set_rand_seed(std::uint64_t seed)
+{
+    detail::rand_seed.store(seed, std::memory_order_relaxed);
+    detail::rand_next_stream.store(1, std::memory_order_relaxed);
+    std::uint32_t generation = detail::rand_generation.fetch_add(1) + 1;
+    detail::thread_random.engine.seed(detail::stream_seed(0));
+    detail::thread_random.generation = generation;
+}
+
+void seed_rand(bool shred)
+{
+    auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    set_rand_seed(static_cast<std::uint64_t>(time(nullptr))
+                  ^ (static_cast<std::uint64_t>(now) << 1));
+    // shred some numbers (kept for old callers, xoshiro's
+    // first numbers are as good as any after seeding)
+    if (shred)
+    {
+        RandomEngine & engine = get_rand_engine();
+        for (int i = 0; i < 20; ++i)
+        {
+            engine();
+        }
+    }
+}
+
+} // namespace LCode